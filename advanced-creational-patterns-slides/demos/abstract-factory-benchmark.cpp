@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "abstract-factory.h"
+#include "../../bench/alloc-counter.h"
+#include "../../bench/bench-util.h"
+
+using namespace abstractFactoryDemo;
+
+/*
+One order = build a machine + coffee family, brew, stir, throw the family away.
+We compare the make_unique factory methods with the arena-backed ones, reporting
+throughput, heap allocations per order and the per-order latency distribution.
+*/
+static const int orders = 2000000;
+
+template <typename HandleOrder>
+static void run(const char *name, HandleOrder handleOrder) {
+	std::vector<double> latencies(orders);
+
+	bench::AllocationStats before = bench::AllocationStats::now();
+	auto start = bench::Clock::now();
+	for (int i = 0; i < orders; i++) {
+		auto orderStart = bench::Clock::now();
+		handleOrder(i);
+		latencies[i] = bench::secondsSince(orderStart) * 1e9;
+	}
+	double seconds = bench::secondsSince(start);
+	bench::AllocationStats allocations = bench::AllocationStats::now() - before;
+
+	std::sort(latencies.begin(), latencies.end());
+	bench::report(name, orders, seconds);
+	std::printf("%-48s %12.2f allocations/order   p50 %.0f ns   p99 %.0f ns   p99.9 %.0f ns\n", "",
+		double(allocations.count) / orders,
+		latencies[orders / 2], latencies[orders * 99 / 100], latencies[orders * 999 / 1000]);
+}
+
+int main() {
+	SimpleCoffeeFactory simpleFactory;
+	RobustCoffeeFactory robustFactory;
+	CoffeeFactory *factories[] = { &simpleFactory, &robustFactory };
+	bench::SilenceStdout silence;
+
+	run("order: make_unique family", [&](int i) {
+		CoffeeFactory &factory = *factories[i & 1];
+		auto machine = factory.createMachine();
+		auto coffee = factory.createCoffee();
+		machine->brew();
+		coffee->stir();
+	});
+
+	OrderArena arena;
+	run("order: OrderArena family", [&](int i) {
+		CoffeeFactory &factory = *factories[i & 1];
+		{
+			CoffeeFactory::Family family = factory.createFamily(arena);
+			family.machine->brew();
+			family.coffee->stir();
+		}
+		arena.release();
+	});
+
+	// Dispatch: the same order through a CoffeeFactory& and through StaticCoffeeFactory.
+	CoffeeFactoryAdapter<SimpleFamily> adapter;
+	CoffeeFactory &runtimeFactory = adapter;
+	run("dispatch: CoffeeFactory& (virtual)", [&](int) {
+		auto machine = runtimeFactory.createMachine();
+		auto coffee = runtimeFactory.createCoffee();
+		machine->brew();
+		coffee->stir();
+	});
+	run("dispatch: CoffeeFactory& + arena (virtual)", [&](int) {
+		{
+			CoffeeFactory::Family family = runtimeFactory.createFamily(arena);
+			family.machine->brew();
+			family.coffee->stir();
+		}
+		arena.release();
+	});
+	run("dispatch: StaticCoffeeFactory<SimpleFamily>", [&](int) {
+		auto machine = StaticCoffeeFactory<SimpleFamily>::createMachine();
+		auto coffee = StaticCoffeeFactory<SimpleFamily>::createCoffee();
+		machine.brew();
+		coffee.stir();
+	});
+
+	return EXIT_SUCCESS;
+}
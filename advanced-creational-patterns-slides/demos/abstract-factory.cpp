@@ -1,104 +1,11 @@
 #include <iostream>
 #include <memory>
+#include "abstract-factory.h"
 
-//Base Abstract Class
-class CoffeeMachine {
-	public:
-		virtual void brew() = 0;
-};
- 
-//Concrete Class 
-class SimpleCoffeeMachine: public CoffeeMachine {
-	public:
-		void brew() {
-			std::cout << "Brewing simple coffee \n";
-		}
-};
-
-//Concrete class
-class RobustCoffeeMachine: public CoffeeMachine  {
-	public:
-		void brew() {
-			std::cout << "Brewing robust coffee \n";
-		}
-};
+using namespace abstractFactoryDemo;
 
-//Here we then have three more classes, which define a different family of objects. 
-//In practice, a coffee machine would probably create a coffee type, maybe even via a factory
-// of its own.
-
-/*
-Maybe even via a factory of its own, and so they wouldn't really be brother or sister objects
-created by the same factory. 
-But for the purpose of this demonstration, 
-we're going to pretend that that relationship doesn't exist.
-*/
-class Coffee {
-	public:
-		virtual void stir() = 0;
-};
- 
-class SimpleCoffee: public Coffee {
-	public:
-		void stir() {
-			std::cout << "Stirring simple coffee \n";
-		}
-};
- 
-class RobustCoffee: public Coffee  {
-	public:
-		void stir() {
-			std::cout << "Stirring robust coffee \n";
-		}
-};
-
-// This is our abstract factory class
-/*
-First up, we have our abstract base class, CoffeeFactory. 
-
-It has two virtual methods on it, one for each type of object 
-this factory can create, createMachine() and createCoffee(). 
-
-And then, taking some inspiration from the last clip, we have two concrete factory 
-implementations. 
-
-We have a SimpleCoffeeFactory and a RobustCoffeeFactory. 
-
-Each of these factories implements the virtual methods of the base class in its own unique way.
-
-The SimpleCoffeeFactory returns a smart pointer to a SimpleCoffeeMachine and 
-a SimpleCoffee depending upon the method called, while the RobustCoffeeFactory 
-returns the robust equivalent
-*/
-
-class CoffeeFactory {
-	public:
-		virtual std::unique_ptr<CoffeeMachine> createMachine() = 0;
-		virtual std::unique_ptr<Coffee> createCoffee() = 0;
-};
-
-// We can implement individual factories which include factory methods for a family of objects 
-class SimpleCoffeeFactory : public CoffeeFactory {
-	public:
-		std::unique_ptr<CoffeeMachine> createMachine() {
-			return std::make_unique<SimpleCoffeeMachine>();
-		}
-
-		std::unique_ptr<Coffee> createCoffee() {
-			return std::make_unique<SimpleCoffee>();
-		}
-};
- 
-class RobustCoffeeFactory : public CoffeeFactory {
-	public:
-		std::unique_ptr<CoffeeMachine> createMachine() {
-			return std::make_unique<RobustCoffeeMachine>();
-		}
-
-		std::unique_ptr<Coffee> createCoffee() {
-			return std::make_unique<RobustCoffee>();
-		}
-};
+// The products and factories live in abstract-factory.h so that
+// the benchmarks can share them with this demo.
 
 /*
 Let's jump into the main function to see how this code can be used. 
@@ -138,5 +45,23 @@ int main()
 	coffeeMachineTwo->brew();
 	coffeeTwo->stir();
 
+	// A whole family for one order, placed in one arena and released with it
+	OrderArena arena;
+	CoffeeFactory::Family order = factoryTwo->createFamily(arena);
+	order.machine->brew();
+	order.coffee->stir();
+
+	// The family chosen at compile time: no factory object, no heap, no virtual calls
+	using DeploymentFactory = StaticCoffeeFactory<RobustFamily>;
+	auto coffeeMachineThree = DeploymentFactory::createMachine();
+	auto coffeeThree = DeploymentFactory::createCoffee();
+	coffeeMachineThree.brew();
+	coffeeThree.stir();
+
+	// ...and handed to code that expects a CoffeeFactory&
+	CoffeeFactoryAdapter<RobustFamily> adapter;
+	CoffeeFactory& factoryThree = adapter;
+	factoryThree.createMachine()->brew();
+
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,194 @@
+#pragma once
+#include <iostream>
+#include <memory>
+
+#include "../../common/any-machine.h"
+#include "../../instrumentation/creation-stats.h"
+#include "order-arena.h"
+
+namespace abstractFactoryDemo {
+
+	//Base Abstract Class
+	class CoffeeMachine {
+		public:
+			virtual void brew() = 0;
+			virtual ~CoffeeMachine() = default;
+	};
+
+	//Concrete Class 
+	class SimpleCoffeeMachine final : public CoffeeMachine {
+		public:
+			void brew() {
+				std::cout << "Brewing simple coffee \n";
+			}
+	};
+
+	//Concrete class
+	class RobustCoffeeMachine final : public CoffeeMachine  {
+		public:
+			void brew() {
+				std::cout << "Brewing robust coffee \n";
+			}
+	};
+
+	// A machine held by value, inside the handle when it is small enough (see common/any-machine.h).
+	using AnyCoffeeMachine = BasicAnyCoffeeMachine<CoffeeMachine>;
+
+	//Here we then have three more classes, which define a different family of objects. 
+	//In practice, a coffee machine would probably create a coffee type, maybe even via a factory
+	// of its own.
+
+	/*
+	Maybe even via a factory of its own, and so they wouldn't really be brother or sister objects
+	created by the same factory. 
+	But for the purpose of this demonstration, 
+	we're going to pretend that that relationship doesn't exist.
+	*/
+	class Coffee {
+		public:
+			virtual void stir() = 0;
+			virtual ~Coffee() = default;
+	};
+
+	class SimpleCoffee final : public Coffee {
+		public:
+			void stir() {
+				std::cout << "Stirring simple coffee \n";
+			}
+	};
+
+	class RobustCoffee final : public Coffee  {
+		public:
+			void stir() {
+				std::cout << "Stirring robust coffee \n";
+			}
+	};
+
+	// This is our abstract factory class
+	/*
+	First up, we have our abstract base class, CoffeeFactory. 
+
+	It has two virtual methods on it, one for each type of object 
+	this factory can create, createMachine() and createCoffee(). 
+
+	And then, taking some inspiration from the last clip, we have two concrete factory 
+	implementations. 
+
+	We have a SimpleCoffeeFactory and a RobustCoffeeFactory. 
+
+	Each of these factories implements the virtual methods of the base class in its own unique way.
+
+	The SimpleCoffeeFactory returns a smart pointer to a SimpleCoffeeMachine and 
+	a SimpleCoffee depending upon the method called, while the RobustCoffeeFactory 
+	returns the robust equivalent
+	*/
+
+	class CoffeeFactory {
+		public:
+			virtual std::unique_ptr<CoffeeMachine> createMachine() = 0;
+			virtual std::unique_ptr<Coffee> createCoffee() = 0;
+
+	/*
+	The same two factory methods, but placing the products in an OrderArena instead of on the heap.
+	A request handler creates a whole family for one order, uses it, and drops it together with the
+	arena - one buffer, no per-object heap allocation, and nothing freed one object at a time.
+	*/
+			virtual ArenaPtr<CoffeeMachine> createMachine(OrderArena &arena) = 0;
+			virtual ArenaPtr<Coffee> createCoffee(OrderArena &arena) = 0;
+
+			// The machine by value, with no heap allocation and no arena to keep alive.
+			virtual AnyCoffeeMachine createAnyMachine() = 0;
+
+			// A matching machine and coffee for one order. Must not outlive the arena they were made in.
+			struct Family {
+				ArenaPtr<CoffeeMachine> machine;
+				ArenaPtr<Coffee> coffee;
+			};
+
+			Family createFamily(OrderArena &arena) {
+				return { createMachine(arena), createCoffee(arena) };
+			}
+
+			virtual ~CoffeeFactory() = default;
+	};
+
+	/*
+	Each concrete factory creates one family of objects. A family is just a traits struct naming its
+	concrete types, so the factory methods are written once, in CoffeeFactoryAdapter below, and
+	every family's factory - and StaticCoffeeFactory further down - creates from the same traits.
+	*/
+	struct SimpleFamily {
+		using MachineType = SimpleCoffeeMachine;
+		using CoffeeType = SimpleCoffee;
+		// How the creation stats label the products.
+		static constexpr const char *machineName = "SimpleCoffeeMachine";
+		static constexpr const char *coffeeName = "SimpleCoffee";
+	};
+
+	struct RobustFamily {
+		using MachineType = RobustCoffeeMachine;
+		using CoffeeType = RobustCoffee;
+		static constexpr const char *machineName = "RobustCoffeeMachine";
+		static constexpr const char *coffeeName = "RobustCoffee";
+	};
+
+	// The runtime interface, implemented for any family.
+	template <typename FamilyTraits>
+	class CoffeeFactoryAdapter : public CoffeeFactory {
+		public:
+			std::unique_ptr<CoffeeMachine> createMachine() {
+				RECORD_CREATION("CoffeeFactory::createMachine", FamilyTraits::machineName);
+				return std::make_unique<typename FamilyTraits::MachineType>();
+			}
+
+			std::unique_ptr<Coffee> createCoffee() {
+				RECORD_CREATION("CoffeeFactory::createCoffee", FamilyTraits::coffeeName);
+				return std::make_unique<typename FamilyTraits::CoffeeType>();
+			}
+
+			ArenaPtr<CoffeeMachine> createMachine(OrderArena &arena) {
+				RECORD_CREATION("CoffeeFactory::createMachine(arena)", FamilyTraits::machineName);
+				return arena.make<typename FamilyTraits::MachineType>();
+			}
+
+			ArenaPtr<Coffee> createCoffee(OrderArena &arena) {
+				RECORD_CREATION("CoffeeFactory::createCoffee(arena)", FamilyTraits::coffeeName);
+				return arena.make<typename FamilyTraits::CoffeeType>();
+			}
+
+			AnyCoffeeMachine createAnyMachine() {
+				RECORD_CREATION("CoffeeFactory::createAnyMachine", FamilyTraits::machineName);
+				return typename FamilyTraits::MachineType();
+			}
+	};
+
+	// We can implement individual factories which include factory methods for a family of objects
+	class SimpleCoffeeFactory : public CoffeeFactoryAdapter<SimpleFamily> {};
+
+	class RobustCoffeeFactory : public CoffeeFactoryAdapter<RobustFamily> {};
+
+	/*
+	When the family is fixed for a whole deployment, we don't need to choose it at runtime at all.
+	StaticCoffeeFactory<FamilyTraits> creates the family's products by value. The compiler knows
+	every concrete type, so brew() and stir() are direct calls it can inline, and the products can
+	live on the stack.
+	(The concrete products are "final" so the compiler is allowed to make that assumption.)
+	Code that still takes a CoffeeFactory& gets the same family through CoffeeFactoryAdapter.
+	*/
+	template <typename FamilyTraits>
+	class StaticCoffeeFactory {
+		public:
+			using MachineType = typename FamilyTraits::MachineType;
+			using CoffeeType = typename FamilyTraits::CoffeeType;
+
+			static MachineType createMachine() {
+				RECORD_CREATION("StaticCoffeeFactory::createMachine", FamilyTraits::machineName);
+				return MachineType();
+			}
+
+			static CoffeeType createCoffee() {
+				RECORD_CREATION("StaticCoffeeFactory::createCoffee", FamilyTraits::coffeeName);
+				return CoffeeType();
+			}
+	};
+}
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <stdexcept>
+#include "async-coffee-service.h"
+
+namespace dependencyInjectionDemo {
+
+	namespace {
+		std::uint64_t nowNs() {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		std::atomic<std::uint64_t> nextServiceId{ 1 };
+	}
+
+	AsyncCoffeeService::ThreadRings::~ThreadRings() {
+		// The thread is exiting: any thread may take these rings over, events still in them included.
+		for (auto& entry : rings) {
+			entry.second->claimed.store(false, std::memory_order_release);
+		}
+	}
+
+	AsyncCoffeeService::ThreadRings& AsyncCoffeeService::threadRings() {
+		thread_local ThreadRings mine;
+		return mine;
+	}
+
+	AsyncCoffeeService::AsyncCoffeeService(const std::string& metricsPath, std::chrono::milliseconds flushInterval)
+		: serviceId(nextServiceId.fetch_add(1, std::memory_order_relaxed)), flushInterval(flushInterval),
+		  metricsFile(metricsPath, std::ios::app) {
+		if (!metricsFile) {
+			throw std::runtime_error("AsyncCoffeeService: cannot open metrics file \"" + metricsPath + "\"");
+		}
+		aggregator = std::thread(&AsyncCoffeeService::aggregateLoop, this);
+	}
+
+	AsyncCoffeeService::~AsyncCoffeeService() {
+		{
+			std::lock_guard<std::mutex> lock(flushMutex);
+			stopping = true;
+		}
+		wake.notify_one();
+		aggregator.join();
+
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		for (const auto& ring : rings) {
+			ring->orphaned.store(true, std::memory_order_release);
+		}
+	}
+
+	void AsyncCoffeeService::sendMetrics() {
+		Ring& ring = threadRing();
+		std::size_t tail = ring.tail.load(std::memory_order_relaxed);
+		if (tail - ring.head.load(std::memory_order_acquire) == Ring::capacity) {
+			// Only this thread writes the counter, so no read-modify-write is needed.
+			ring.droppedEvents.store(ring.droppedEvents.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+		ring.timestamps[tail % Ring::capacity] = nowNs();
+		ring.tail.store(tail + 1, std::memory_order_release);
+
+		// Half full: don't wait for the next interval. Happens at most once per half ring, so the
+		// notify stays off the common path; a wake-up lost to a race only delays the drain until the interval.
+		if (tail - ring.head.load(std::memory_order_relaxed) == Ring::capacity / 2) {
+			wake.notify_one();
+		}
+	}
+
+	AsyncCoffeeService::Ring& AsyncCoffeeService::threadRing() {
+		ThreadRings& mine = threadRings();
+		if (mine.lastServiceId == serviceId) {
+			return *mine.lastRing;
+		}
+
+		// This thread last used another service (or none): look for its ring here.
+		for (const auto& entry : mine.rings) {
+			if (entry.first == serviceId) {
+				mine.lastServiceId = serviceId;
+				mine.lastRing = entry.second.get();
+				return *mine.lastRing;
+			}
+		}
+
+		// First use of this service on this thread. Forget the rings of services that are gone,
+		// then take over a ring an exited thread handed back, or make a new one.
+		mine.rings.erase(std::remove_if(mine.rings.begin(), mine.rings.end(),
+			[](const auto& entry) { return entry.second->orphaned.load(std::memory_order_acquire); }),
+			mine.rings.end());
+
+		std::shared_ptr<Ring> ring;
+		{
+			std::lock_guard<std::mutex> lock(ringsMutex);
+			for (const auto& candidate : rings) {
+				bool expected = false;
+				if (candidate->claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+					ring = candidate;
+					break;
+				}
+			}
+			if (!ring) {
+				ring = std::make_shared<Ring>();
+				rings.push_back(ring);
+			}
+		}
+		mine.rings.emplace_back(serviceId, ring);
+		mine.lastServiceId = serviceId;
+		mine.lastRing = ring.get();
+		return *ring;
+	}
+
+	bool AsyncCoffeeService::ringsHalfFull() const {
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		for (const auto& ring : rings) {
+			if (ring->tail.load(std::memory_order_relaxed) - ring->head.load(std::memory_order_relaxed) >= Ring::capacity / 2) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::uint64_t AsyncCoffeeService::dropped() const {
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		std::uint64_t total = 0;
+		for (const auto& ring : rings) {
+			total += ring->droppedEvents.load(std::memory_order_relaxed);
+		}
+		return total;
+	}
+
+	void AsyncCoffeeService::drain(Ring& ring, Batch& batch) {
+		std::size_t head = ring.head.load(std::memory_order_relaxed);
+		std::size_t tail = ring.tail.load(std::memory_order_acquire);
+		if (head == tail) {
+			return;
+		}
+
+		std::uint64_t first = ring.timestamps[head % Ring::capacity];
+		std::uint64_t last = ring.timestamps[(tail - 1) % Ring::capacity];
+		batch.firstNs = batch.events == 0 ? first : std::min(batch.firstNs, first);
+		batch.lastNs = std::max(batch.lastNs, last);
+		batch.events += tail - head;
+
+		ring.head.store(tail, std::memory_order_release);
+	}
+
+	void AsyncCoffeeService::aggregateLoop() {
+		for (;;) {
+			std::uint64_t request;
+			bool last;
+			{
+				std::unique_lock<std::mutex> lock(flushMutex);
+				wake.wait_for(lock, flushInterval, [this] { return stopping || flushRequested != flushCompleted || ringsHalfFull(); });
+				request = flushRequested;
+				last = stopping;
+			}
+
+			std::vector<Ring*> current;
+			{
+				std::lock_guard<std::mutex> lock(ringsMutex);
+				for (const auto& ring : rings) {
+					current.push_back(ring.get());
+				}
+			}
+
+			Batch batch;
+			std::uint64_t droppedNow = 0;
+			for (Ring* ring : current) {
+				drain(*ring, batch);
+				droppedNow += ring->droppedEvents.load(std::memory_order_relaxed);
+			}
+
+			if (batch.events != 0 || droppedNow != droppedWritten) {
+				metricsFile << "batch=" << batchesWritten++ << " brews=" << batch.events
+					<< " dropped=" << droppedNow - droppedWritten
+					<< " span_us=" << (batch.lastNs - batch.firstNs) / 1000 << '\n';
+				metricsFile.flush();
+				droppedWritten = droppedNow;
+				recordedTotal.fetch_add(batch.events, std::memory_order_release);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(flushMutex);
+				flushCompleted = request;
+			}
+			flushed.notify_all();
+
+			if (last) {
+				return;
+			}
+		}
+	}
+
+	void AsyncCoffeeService::flush() {
+		std::unique_lock<std::mutex> lock(flushMutex);
+		std::uint64_t target = ++flushRequested;
+		wake.notify_one();
+		flushed.wait(lock, [this, target] { return flushCompleted >= target || stopping; });
+	}
+}
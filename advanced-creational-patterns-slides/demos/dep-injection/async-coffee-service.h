@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "icoffee-service.h"
+
+namespace dependencyInjectionDemo {
+
+	/*
+	A coffee service that keeps metrics I/O off the brew path.
+
+	sendMetrics() only appends a timestamp to a ring buffer owned by the calling thread - no lock,
+	no allocation, no I/O. A background thread drains every ring, aggregates what it found into one
+	batch, and appends a line per batch to the metrics file (which stands in for the socket a real
+	metrics agent would listen on). If a thread brews faster than the background thread drains,
+	it is woken early once a ring is half full; if the ring fills up anyway, further events are
+	counted as dropped rather than slowing the brew down.
+
+	One service can be shared by machines on many threads; each thread gets its own ring the first
+	time it sends metrics through this service, and hands it back when it exits for the next new
+	thread to take over. A service used by a stream of short-lived threads therefore holds only as
+	many rings as there were threads sending at once.
+	*/
+	class AsyncCoffeeService : public ICoffeeService {
+		public:
+			explicit AsyncCoffeeService(const std::string& metricsPath,
+				std::chrono::milliseconds flushInterval = std::chrono::milliseconds(10));
+
+			// Writes whatever is still buffered, then stops the background thread.
+			~AsyncCoffeeService() override;
+
+			AsyncCoffeeService(const AsyncCoffeeService&) = delete;
+			AsyncCoffeeService& operator=(const AsyncCoffeeService&) = delete;
+
+			void sendMetrics() override;
+
+			// Blocks until every event sent before the call has been written out.
+			void flush();
+
+			// Events written to the file so far, and events lost to full rings.
+			std::uint64_t recorded() const { return recordedTotal.load(std::memory_order_acquire); }
+			std::uint64_t dropped() const;
+
+		private:
+			// Single producer (the owning thread), single consumer (the background thread).
+			struct Ring {
+				static constexpr std::size_t capacity = 16384;
+
+				alignas(64) std::atomic<std::size_t> head{ 0 }; // next slot to read
+				alignas(64) std::atomic<std::size_t> tail{ 0 }; // next slot to write
+				std::atomic<std::uint64_t> droppedEvents{ 0 };
+				std::atomic<bool> claimed{ true };   // a live thread writes to it; cleared when that thread exits
+				std::atomic<bool> orphaned{ false }; // its service is gone; threads drop it from their lists
+				std::uint64_t timestamps[capacity];
+			};
+
+			/*
+			The rings this thread writes to, one per service it has sent metrics through. A thread
+			talks to a handful of services at most, so this is a short list, with the last one used
+			checked first. The rings are shared with their services, so whichever goes first, the
+			other can still hand them back.
+			*/
+			struct ThreadRings {
+				std::uint64_t lastServiceId = 0;
+				Ring* lastRing = nullptr;
+				std::vector<std::pair<std::uint64_t, std::shared_ptr<Ring>>> rings;
+
+				~ThreadRings();
+			};
+
+			struct Batch {
+				std::uint64_t events = 0;
+				std::uint64_t firstNs = 0;
+				std::uint64_t lastNs = 0;
+			};
+
+			static ThreadRings& threadRings();
+			Ring& threadRing();
+			bool ringsHalfFull() const;
+			void drain(Ring& ring, Batch& batch);
+			void aggregateLoop();
+
+			const std::uint64_t serviceId; // tells services apart in ThreadRings; never reused
+			const std::chrono::milliseconds flushInterval;
+			std::ofstream metricsFile;
+
+			// Ring registration is rare (once per thread), so a plain mutex is fine.
+			mutable std::mutex ringsMutex;
+			std::vector<std::shared_ptr<Ring>> rings;
+
+			std::mutex flushMutex;
+			std::condition_variable wake;
+			std::condition_variable flushed;
+			std::uint64_t flushRequested = 0;
+			std::uint64_t flushCompleted = 0;
+			bool stopping = false;
+
+			std::atomic<std::uint64_t> recordedTotal{ 0 };
+			std::uint64_t droppedWritten = 0; // background thread only
+			std::uint64_t batchesWritten = 0; // background thread only
+
+			std::thread aggregator;
+	};
+}
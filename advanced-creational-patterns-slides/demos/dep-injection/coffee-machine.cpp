@@ -1,14 +1,17 @@
 #include <iostream>
 #include "coffee-machine.h"
 
-/*Step 2
-We define the brew method, which simply writes to the console and 
-then calls the sendMetrics function located on the CoffeeService reference 
-that is available to the class.
-*/
+namespace dependencyInjectionDemo {
 
-void CoffeeMachine::brew() {
-	std::cout << "Brewing coffee!\n";
+	/*Step 2
+	We define the brew method, which simply writes to the console and 
+	then calls the sendMetrics function located on the CoffeeService reference 
+	that is available to the class.
+	*/
 
-	coffeeService->sendMetrics();
-}
\ No newline at end of file
+	void CoffeeMachine::brew() {
+		std::cout << "Brewing coffee!\n";
+
+		coffeeService->sendMetrics();
+	}
+}
@@ -1,22 +1,65 @@
 #pragma once
 
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include "../../../instrumentation/creation-stats.h"
 #include "icoffee-service.h"
 
-class CoffeeMachine {
-	public:
-	/*Step 1
-	In this header file, we have declared the CoffeeMachine class. 
-	This class has a public constructor 
-	that expects a reference to a CoffeeService interface. 
-	More on that later. 
-	This constructor takes advantage of "move" semantics 
-	to set the private internal reference of this dependency.
-	*/
-		CoffeeMachine(std::unique_ptr<ICoffeeService>&& coffeeSvc) : coffeeService(std::move(coffeeSvc)) {}
-
-		void brew();
-
-	private:
-		std::unique_ptr<ICoffeeService> coffeeService;
-};
+namespace dependencyInjectionDemo {
+
+	class CoffeeMachine {
+		public:
+		/*Step 1
+		In this header file, we have declared the CoffeeMachine class. 
+		This class has a public constructor 
+		that expects a reference to a CoffeeService interface. 
+		More on that later. 
+		This constructor takes advantage of "move" semantics 
+		to set the private internal reference of this dependency.
+		*/
+			CoffeeMachine(std::unique_ptr<ICoffeeService>&& coffeeSvc) : ownedService(std::move(coffeeSvc)), coffeeService(ownedService.get()) {
+				RECORD_CREATION("CoffeeMachine(ICoffeeService)", "owned service");
+			}
+
+		/*
+		A whole fleet usually reports to the same backend, so one service instance can back many machines.
+		Shared: the service lives as long as the last machine (or anyone else) holding it.
+		Borrowed: the machine only refers to a service that someone else keeps alive for longer than the machine.
+		*/
+			template <typename Service, typename = std::enable_if_t<std::is_convertible_v<Service *, ICoffeeService *>>>
+			explicit CoffeeMachine(std::shared_ptr<Service> coffeeSvc) : coffeeService(coffeeSvc.get()), sharedOwner(std::move(coffeeSvc)) {
+				RECORD_CREATION("CoffeeMachine(ICoffeeService)", "shared service");
+			}
+
+			explicit CoffeeMachine(ICoffeeService& coffeeSvc) : coffeeService(&coffeeSvc) {
+				RECORD_CREATION("CoffeeMachine(ICoffeeService)", "borrowed service");
+			}
+
+			// Move-only, like the owned service: a moved-from machine has no service left.
+			CoffeeMachine(CoffeeMachine&& other) noexcept
+				: ownedService(std::move(other.ownedService)),
+				  coffeeService(std::exchange(other.coffeeService, nullptr)),
+				  sharedOwner(std::move(other.sharedOwner)) {}
+
+			CoffeeMachine& operator=(CoffeeMachine&& other) noexcept {
+				ownedService = std::move(other.ownedService);
+				coffeeService = std::exchange(other.coffeeService, nullptr);
+				sharedOwner = std::move(other.sharedOwner);
+				return *this;
+			}
+
+			void brew();
+
+		private:
+			/*
+			brew() always goes through "coffeeService". At most one of the owners below is set:
+			"ownedService" for a service handed over with its unique_ptr, "sharedOwner" for a
+			shared one. A borrowed service has neither, so owning or borrowing costs no allocation
+			and no reference count.
+			*/
+			std::unique_ptr<ICoffeeService> ownedService;
+			ICoffeeService *coffeeService;
+			std::shared_ptr<void> sharedOwner;
+	};
+}
@@ -0,0 +1,78 @@
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "../../../bench/alloc-counter.h"
+#include "../../../bench/bench-util.h"
+#include "coffee-machine.h"
+
+using namespace dependencyInjectionDemo;
+
+/*
+Memory and time to build a fleet of machines that all report to the same metrics backend,
+with each machine owning its own service vs sharing or borrowing one instance.
+
+Build:
+	g++ -std=c++17 -O2 -pthread fleet-benchmark.cpp coffee-machine.cpp -o fleet-benchmark
+
+A metrics client is rarely empty - it holds a connection, buffers, tags - so the service here
+carries a small payload to stand in for that. Bytes are what the fleet asked the heap for,
+including the vector holding the machines.
+*/
+
+namespace {
+	struct BackendCoffeeService : ICoffeeService {
+		char endpoint[64] = "metrics.local:8125";
+		long sent = 0;
+
+		void sendMetrics() override { sent++; }
+	};
+
+	template <typename MakeMachine>
+	void buildFleet(const char* name, std::size_t fleetSize, MakeMachine makeMachine) {
+		bench::AllocationStats before = bench::AllocationStats::now();
+		bench::Clock::time_point start = bench::Clock::now();
+
+		std::vector<CoffeeMachine> fleet;
+		fleet.reserve(fleetSize);
+		for (std::size_t i = 0; i < fleetSize; i++) {
+			fleet.push_back(makeMachine());
+		}
+
+		double seconds = bench::secondsSince(start);
+		bench::AllocationStats used = bench::AllocationStats::now() - before;
+		bench::report(name, double(fleetSize), seconds);
+		std::printf("%-48s %12zu allocations %10.2f MB %8.1f bytes/machine\n", "",
+			used.count, used.bytes / 1e6, double(used.bytes) / fleetSize);
+
+		bench::SilenceStdout silence;
+		for (CoffeeMachine& machine : fleet) {
+			machine.brew();
+		}
+	}
+}
+
+int main() {
+	const std::size_t fleetSize = 100000;
+	std::printf("sizeof(CoffeeMachine) = %zu, sizeof(BackendCoffeeService) = %zu\n\n", sizeof(CoffeeMachine), sizeof(BackendCoffeeService));
+
+	buildFleet("100k machines, each owns its service", fleetSize, [] {
+		return CoffeeMachine(std::make_unique<BackendCoffeeService>());
+	});
+
+	auto shared = std::make_shared<BackendCoffeeService>();
+	buildFleet("100k machines, one shared service", fleetSize, [&shared] {
+		return CoffeeMachine(shared);
+	});
+
+	BackendCoffeeService borrowed;
+	buildFleet("100k machines, one borrowed service", fleetSize, [&borrowed] {
+		return CoffeeMachine(borrowed);
+	});
+
+	if (shared->sent != long(fleetSize) || borrowed.sent != long(fleetSize) || shared.use_count() != 1) {
+		std::printf("FAILED: every machine should have reported once to its fleet's service\n");
+		return 1;
+	}
+	return 0;
+}
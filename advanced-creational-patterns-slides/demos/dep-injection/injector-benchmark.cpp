@@ -0,0 +1,160 @@
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+
+#include "../../../bench/bench-util.h"
+#include "icoffee-service.h"
+#include "injector.h"
+
+using namespace dependencyInjectionDemo;
+
+/*
+Resolving a deep object graph once per request, and how long the injector takes to start.
+
+Build:
+	g++ -std=c++17 -O2 -pthread injector-benchmark.cpp -o injector-benchmark
+
+The graph is a chain of "graphDepth" layers, each holding the layer below it and the metrics
+service. Every eighth layer is scoped, the rest are transient, and the metrics service is a
+singleton. Each request opens a scope and resolves the top of the chain, which is compared against
+wiring the same chain by hand and against a typical map-based resolver that looks every
+dependency up by std::type_index. tests/injector-test.cpp checks that the injector gets it right.
+*/
+
+namespace {
+	constexpr int graphDepth = 64;
+
+	struct NullCoffeeService : ICoffeeService {
+		void sendMetrics() override {}
+	};
+
+	template <int Depth>
+	struct Layer {
+		std::shared_ptr<Layer<Depth - 1>> inner;
+		std::shared_ptr<ICoffeeService> metrics;
+
+		Layer(std::shared_ptr<Layer<Depth - 1>> inner, std::shared_ptr<ICoffeeService> metrics)
+			: inner(std::move(inner)), metrics(std::move(metrics)) {}
+	};
+
+	template <>
+	struct Layer<0> {
+		std::shared_ptr<ICoffeeService> metrics;
+
+		explicit Layer(std::shared_ptr<ICoffeeService> metrics) : metrics(std::move(metrics)) {}
+	};
+
+	constexpr ServiceLifetime layerLifetime(int depth) {
+		return depth % 8 == 0 ? ServiceLifetime::scoped : ServiceLifetime::transient;
+	}
+
+	template <std::size_t... Depth>
+	void addLayers(InjectorBuilder &builder, std::index_sequence<Depth...>) {
+		(builder.add<Layer<Depth + 1>, Layer<Depth + 1>, Layer<Depth>, ICoffeeService>(layerLifetime(Depth + 1)), ...);
+	}
+
+	Injector buildInjector() {
+		InjectorBuilder builder;
+		builder.add<ICoffeeService, NullCoffeeService>(ServiceLifetime::singleton);
+		builder.add<Layer<0>, Layer<0>, ICoffeeService>(layerLifetime(0));
+		addLayers(builder, std::make_index_sequence<graphDepth>{});
+		return builder.build();
+	}
+
+	template <int Depth>
+	std::shared_ptr<Layer<Depth>> wireByHand(const std::shared_ptr<ICoffeeService> &metrics) {
+		if constexpr (Depth == 0) {
+			return std::make_shared<Layer<0>>(metrics);
+		} else {
+			return std::make_shared<Layer<Depth>>(wireByHand<Depth - 1>(metrics), metrics);
+		}
+	}
+
+	// What a straightforward runtime container does: a hash lookup per dependency, keyed by RTTI.
+	class MapInjector {
+		struct Entry {
+			ServiceLifetime lifetime;
+			std::function<std::shared_ptr<void>(MapInjector &)> create;
+		};
+
+		std::unordered_map<std::type_index, Entry> entries;
+		std::unordered_map<std::type_index, std::shared_ptr<void>> singletons;
+		std::unordered_map<std::type_index, std::shared_ptr<void>> scoped;
+
+		public:
+			template <typename Interface, typename Implementation, typename... Dependencies>
+			void add(ServiceLifetime lifetime) {
+				entries[typeid(Interface)] = { lifetime, [](MapInjector &injector) -> std::shared_ptr<void> {
+					return std::shared_ptr<Interface>(std::make_shared<Implementation>(injector.resolve<Dependencies>()...));
+				} };
+			}
+
+			void beginScope() { scoped.clear(); }
+
+			template <typename Service>
+			std::shared_ptr<Service> resolve() {
+				std::type_index type(typeid(Service));
+				const Entry &entry = entries.at(type);
+				if (entry.lifetime != ServiceLifetime::transient) {
+					auto &cache = entry.lifetime == ServiceLifetime::singleton ? singletons : scoped;
+					auto found = cache.find(type);
+					if (found == cache.end()) {
+						found = cache.emplace(type, entry.create(*this)).first;
+					}
+					return std::static_pointer_cast<Service>(found->second);
+				}
+				return std::static_pointer_cast<Service>(entry.create(*this));
+			}
+	};
+
+	template <std::size_t... Depth>
+	void addLayers(MapInjector &injector, std::index_sequence<Depth...>) {
+		(injector.add<Layer<Depth + 1>, Layer<Depth + 1>, Layer<Depth>, ICoffeeService>(layerLifetime(Depth + 1)), ...);
+	}
+}
+
+int main() {
+	// Startup: registering the graph, validating it, compiling the plans and creating the singletons.
+	const int startups = 2000;
+	bench::Clock::time_point start = bench::Clock::now();
+	for (int i = 0; i < startups; i++) {
+		Injector injector = buildInjector();
+		bench::doNotOptimize(injector);
+	}
+	bench::report("injector startup (66 services)", startups, bench::secondsSince(start));
+
+	const int requests = 200000;
+	Injector injector = buildInjector();
+
+	start = bench::Clock::now();
+	for (int i = 0; i < requests; i++) {
+		Injector::Scope request(injector);
+		std::shared_ptr<Layer<graphDepth>> top = request.resolve<Layer<graphDepth>>();
+		bench::doNotOptimize(top);
+	}
+	bench::report("resolve 65-deep graph per request, Injector", requests, bench::secondsSince(start));
+
+	std::shared_ptr<ICoffeeService> metrics = std::make_shared<NullCoffeeService>();
+	start = bench::Clock::now();
+	for (int i = 0; i < requests; i++) {
+		std::shared_ptr<Layer<graphDepth>> top = wireByHand<graphDepth>(metrics);
+		bench::doNotOptimize(top);
+	}
+	bench::report("resolve 65-deep graph per request, by hand", requests, bench::secondsSince(start));
+
+	MapInjector mapInjector;
+	mapInjector.add<ICoffeeService, NullCoffeeService>(ServiceLifetime::singleton);
+	mapInjector.add<Layer<0>, Layer<0>, ICoffeeService>(layerLifetime(0));
+	addLayers(mapInjector, std::make_index_sequence<graphDepth>{});
+	start = bench::Clock::now();
+	for (int i = 0; i < requests; i++) {
+		mapInjector.beginScope();
+		std::shared_ptr<Layer<graphDepth>> top = mapInjector.resolve<Layer<graphDepth>>();
+		bench::doNotOptimize(top);
+	}
+	bench::report("resolve 65-deep graph per request, type_index map", requests, bench::secondsSince(start));
+	return 0;
+}
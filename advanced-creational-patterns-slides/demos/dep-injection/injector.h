@@ -0,0 +1,367 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dependencyInjectionDemo {
+
+	/*
+	A small dependency injection container: the "injector" that main.cpp leaves out.
+
+	Services are registered against an interface with a lifetime:
+		- singleton: one instance for the whole injector, created when the injector is built.
+		- scoped: one instance per Injector::Scope (typically one scope per request).
+		- transient: a new instance every time one is needed.
+
+		InjectorBuilder builder;
+		builder.add<ICoffeeService, SimpleCoffeeService>(ServiceLifetime::singleton);
+		builder.add<Grinder, Grinder, ICoffeeService>(ServiceLifetime::scoped); // Grinder(std::shared_ptr<ICoffeeService>)
+		Injector injector = builder.build();
+
+		Injector::Scope request(injector);
+		std::shared_ptr<Grinder> grinder = request.resolve<Grinder>();
+
+	build() checks the whole graph once - every dependency registered, no cycles, no singleton
+	holding on to a scoped service - and compiles each service, once, into a plan: the positions
+	of its dependencies' registrations, in constructor order. Resolving follows those positions:
+	a singleton is a load, a scoped service is looked up in the scope before it is built, and a
+	transient one is built from its own plan - which every service depending on it shares, so
+	nothing is compiled twice however often a service is used. There are no map lookups and no
+	RTTI at resolve time; a type's position in the injector comes from a per-type index assigned
+	on first use.
+
+	Dependencies are passed to constructors (or factories) as std::shared_ptr<Dependency>.
+	*/
+
+	enum class ServiceLifetime { singleton, scoped, transient };
+
+	namespace injection {
+		inline std::size_t nextServiceTypeIndex() {
+			static std::atomic<std::size_t> next{ 0 };
+			return next.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// A dense, process-wide index per service type, assigned the first time the type is registered or resolved.
+		template <typename Service>
+		std::size_t serviceTypeIndex() {
+			static const std::size_t index = nextServiceTypeIndex();
+			return index;
+		}
+
+		// Builds one object from its dependencies, given in constructor order.
+		using Arguments = const std::shared_ptr<void>* const*;
+		using Creator = std::shared_ptr<void> (*)(void (*factory)(), Arguments arguments);
+
+		// The stored pointer is always converted to Interface first, so it can be cast straight back.
+		template <typename Interface, typename Implementation, typename... Dependencies, std::size_t... I>
+		std::shared_ptr<void> construct(Arguments arguments, std::index_sequence<I...>) {
+			std::shared_ptr<Interface> object = std::make_shared<Implementation>(std::static_pointer_cast<Dependencies>(*arguments[I])...);
+			return object;
+		}
+
+		template <typename Interface, typename Implementation, typename... Dependencies>
+		std::shared_ptr<void> constructWith(void (*)(), Arguments arguments) {
+			return construct<Interface, Implementation, Dependencies...>(arguments, std::index_sequence_for<Dependencies...>{});
+		}
+
+		template <typename Interface, typename... Dependencies, std::size_t... I>
+		std::shared_ptr<void> callFactory(void (*factory)(), Arguments arguments, std::index_sequence<I...>) {
+			auto typedFactory = reinterpret_cast<std::shared_ptr<Interface> (*)(std::shared_ptr<Dependencies>...)>(factory);
+			return typedFactory(std::static_pointer_cast<Dependencies>(*arguments[I])...);
+		}
+
+		template <typename Interface, typename... Dependencies>
+		std::shared_ptr<void> callFactoryWith(void (*factory)(), Arguments arguments) {
+			return callFactory<Interface, Dependencies...>(factory, arguments, std::index_sequence_for<Dependencies...>{});
+		}
+
+		// Spelled through a struct so that a lambda converts to it instead of failing deduction.
+		template <typename Interface, typename... Dependencies>
+		struct Factory {
+			using type = std::shared_ptr<Interface> (*)(std::shared_ptr<Dependencies>...);
+		};
+
+		struct Registration {
+			std::size_t type;
+			ServiceLifetime lifetime;
+			Creator create;
+			void (*factory)();
+			std::vector<std::size_t> dependencyTypes;
+		};
+
+		// A registration, compiled: everything resolving needs, with its dependencies at Injector::dependencies[first, first + count).
+		struct Plan {
+			Creator create;
+			void (*factory)();
+			ServiceLifetime lifetime;
+			std::uint32_t firstDependency;
+			std::uint32_t dependencyCount;
+		};
+
+		/*
+		Scratch space for resolving, kept between resolves. Singletons and scoped instances are
+		passed to constructors where they are stored; only the transient objects built on the way
+		are held here, until whatever needed them has been built. No service appears twice on one
+		path through the graph, so neither stack ever holds more than every dependency at once -
+		reserving that up front keeps the pointers into "built" valid.
+		*/
+		struct ResolveStack {
+			std::vector<const std::shared_ptr<void>*> arguments;
+			std::vector<std::shared_ptr<void>> built;
+
+			explicit ResolveStack(std::size_t dependencyCount) {
+				arguments.reserve(dependencyCount);
+				built.reserve(dependencyCount);
+			}
+		};
+	}
+
+	class Injector;
+
+	class InjectorBuilder {
+		std::vector<injection::Registration> registrations;
+
+		void add(injection::Registration registration) {
+			for (const injection::Registration &existing : registrations) {
+				if (existing.type == registration.type) {
+					throw std::invalid_argument("InjectorBuilder: service #" + std::to_string(registration.type) + " is already registered");
+				}
+			}
+			registrations.push_back(std::move(registration));
+		}
+
+		public:
+			// Interface is resolved as make_shared<Implementation>(std::shared_ptr<Dependencies>...).
+			template <typename Interface, typename Implementation = Interface, typename... Dependencies>
+			InjectorBuilder &add(ServiceLifetime lifetime) {
+				add({ injection::serviceTypeIndex<Interface>(), lifetime,
+					&injection::constructWith<Interface, Implementation, Dependencies...>, nullptr,
+					{ injection::serviceTypeIndex<Dependencies>()... } });
+				return *this;
+			}
+
+			// For types that aren't simply constructed from their dependencies' shared_ptrs.
+			template <typename Interface, typename... Dependencies>
+			InjectorBuilder &addFactory(ServiceLifetime lifetime, typename injection::Factory<Interface, Dependencies...>::type factory) {
+				add({ injection::serviceTypeIndex<Interface>(), lifetime,
+					&injection::callFactoryWith<Interface, Dependencies...>, reinterpret_cast<void (*)()>(factory),
+					{ injection::serviceTypeIndex<Dependencies>()... } });
+				return *this;
+			}
+
+			// Validates and compiles the graph, then creates every singleton. Throws std::logic_error for a bad graph.
+			Injector build() const;
+	};
+
+	class Injector {
+		friend class InjectorBuilder;
+
+		static constexpr std::uint32_t unregistered = UINT32_MAX;
+
+		std::vector<injection::Registration> registrations;
+		std::vector<std::uint32_t> byType; // service type index -> registration index
+		std::vector<injection::Plan> plans; // per registration
+		std::vector<std::uint32_t> dependencies; // registration indices, every plan's back to back
+		std::vector<std::shared_ptr<void>> singletons; // per registration
+
+		Injector() = default;
+
+		template <typename Service>
+		std::uint32_t registrationFor() const {
+			std::size_t type = injection::serviceTypeIndex<Service>();
+			if (type >= byType.size() || byType[type] == unregistered) {
+				throw std::out_of_range("Injector: service #" + std::to_string(type) + " is not registered");
+			}
+			return byType[type];
+		}
+
+		// Builds a new instance of "service" from its plan.
+		std::shared_ptr<void> construct(std::uint32_t service, std::vector<std::shared_ptr<void>> &scoped, injection::ResolveStack &stack) const {
+			const injection::Plan &plan = plans[service];
+			std::size_t argumentsBase = stack.arguments.size();
+			std::size_t builtBase = stack.built.size();
+			try {
+				for (std::uint32_t i = 0; i < plan.dependencyCount; i++) {
+					std::uint32_t dependency = dependencies[plan.firstDependency + i];
+					const std::shared_ptr<void> *argument = nullptr;
+					switch (plans[dependency].lifetime) {
+						case ServiceLifetime::singleton:
+							argument = &singletons[dependency];
+							break;
+						case ServiceLifetime::scoped:
+							if (!scoped[dependency]) {
+								std::shared_ptr<void> instance = construct(dependency, scoped, stack);
+								scoped[dependency] = std::move(instance);
+							}
+							argument = &scoped[dependency];
+							break;
+						case ServiceLifetime::transient: {
+							std::shared_ptr<void> instance = construct(dependency, scoped, stack);
+							stack.built.push_back(std::move(instance));
+							argument = &stack.built.back();
+							break;
+						}
+					}
+					stack.arguments.push_back(argument);
+				}
+				std::shared_ptr<void> object = plan.create(plan.factory, stack.arguments.data() + argumentsBase);
+				stack.arguments.resize(argumentsBase);
+				stack.built.resize(builtBase);
+				return object;
+			} catch (...) {
+				stack.arguments.resize(argumentsBase);
+				stack.built.resize(builtBase);
+				throw;
+			}
+		}
+
+		// The instance of "service" to hand out: the singleton, the scope's own (built on first use) or a new one.
+		std::shared_ptr<void> obtain(std::uint32_t service, std::vector<std::shared_ptr<void>> &scoped, injection::ResolveStack &stack) const {
+			switch (plans[service].lifetime) {
+				case ServiceLifetime::singleton:
+					return singletons[service];
+				case ServiceLifetime::scoped:
+					if (!scoped[service]) {
+						std::shared_ptr<void> instance = construct(service, scoped, stack);
+						scoped[service] = std::move(instance);
+					}
+					return scoped[service];
+				case ServiceLifetime::transient:
+					break;
+			}
+			return construct(service, scoped, stack);
+		}
+
+		public:
+			Injector(Injector &&) = default;
+			Injector &operator=(Injector &&) = default;
+
+			Injector(const Injector &) = delete;
+			Injector &operator=(const Injector &) = delete;
+
+			/*
+			One unit of work. Scoped services are created once per scope and shared by everything
+			resolved through it. A scope is meant for one thread; the injector itself may be shared.
+			*/
+			class Scope {
+				const Injector &injector;
+				std::vector<std::shared_ptr<void>> scoped;
+				injection::ResolveStack stack;
+
+				public:
+					explicit Scope(const Injector &injector)
+						: injector(injector), scoped(injector.registrations.size()), stack(injector.dependencies.size()) {}
+
+					Scope(const Scope &) = delete;
+					Scope &operator=(const Scope &) = delete;
+
+					template <typename Service>
+					std::shared_ptr<Service> resolve() {
+						return std::static_pointer_cast<Service>(injector.obtain(injector.registrationFor<Service>(), scoped, stack));
+					}
+			};
+
+			// Resolves in a scope of its own, so any scoped services in the graph are fresh.
+			template <typename Service>
+			std::shared_ptr<Service> resolve() const {
+				Scope scope(*this);
+				return scope.resolve<Service>();
+			}
+
+			std::size_t size() const { return registrations.size(); }
+	};
+
+	inline Injector InjectorBuilder::build() const {
+		using injection::Registration;
+
+		Injector injector;
+		injector.registrations = registrations;
+
+		std::size_t typeCount = 0;
+		for (const Registration &registration : registrations) {
+			typeCount = std::max(typeCount, registration.type + 1);
+		}
+		injector.byType.assign(typeCount, Injector::unregistered);
+		for (std::size_t i = 0; i < registrations.size(); i++) {
+			injector.byType[registrations[i].type] = static_cast<std::uint32_t>(i);
+		}
+
+		auto registrationOf = [&injector](std::size_t type) {
+			return type < injector.byType.size() ? injector.byType[type] : Injector::unregistered;
+		};
+		for (const Registration &registration : registrations) {
+			for (std::size_t dependencyType : registration.dependencyTypes) {
+				if (registrationOf(dependencyType) == Injector::unregistered) {
+					throw std::logic_error("InjectorBuilder: service #" + std::to_string(registration.type)
+						+ " depends on unregistered service #" + std::to_string(dependencyType));
+				}
+			}
+		}
+
+		// Depth-first walk: rejects cycles and lists the services so that dependencies come first.
+		enum class Mark { unvisited, visiting, done };
+		std::vector<Mark> marks(registrations.size(), Mark::unvisited);
+		std::vector<std::uint32_t> order;
+		auto visit = [&](auto &self, std::uint32_t service) -> void {
+			if (marks[service] == Mark::done) {
+				return;
+			}
+			if (marks[service] == Mark::visiting) {
+				throw std::logic_error("InjectorBuilder: dependency cycle through service #" + std::to_string(registrations[service].type));
+			}
+			marks[service] = Mark::visiting;
+			for (std::size_t dependencyType : registrations[service].dependencyTypes) {
+				self(self, injector.byType[dependencyType]);
+			}
+			marks[service] = Mark::done;
+			order.push_back(service);
+		};
+		for (std::uint32_t service = 0; service < registrations.size(); service++) {
+			visit(visit, service);
+		}
+
+		// A singleton outlives every scope, so it must not capture a scoped service, not even through a transient one.
+		auto capturesScoped = [&](auto &self, std::uint32_t service) -> bool {
+			for (std::size_t dependencyType : registrations[service].dependencyTypes) {
+				std::uint32_t dependency = injector.byType[dependencyType];
+				ServiceLifetime lifetime = registrations[dependency].lifetime;
+				if (lifetime == ServiceLifetime::scoped || (lifetime == ServiceLifetime::transient && self(self, dependency))) {
+					return true;
+				}
+			}
+			return false;
+		};
+		for (std::uint32_t service = 0; service < registrations.size(); service++) {
+			if (registrations[service].lifetime == ServiceLifetime::singleton && capturesScoped(capturesScoped, service)) {
+				throw std::logic_error("InjectorBuilder: singleton service #" + std::to_string(registrations[service].type)
+					+ " depends on a scoped service");
+			}
+		}
+
+		for (const Registration &registration : registrations) {
+			injector.plans.push_back({ registration.create, registration.factory, registration.lifetime,
+				static_cast<std::uint32_t>(injector.dependencies.size()), static_cast<std::uint32_t>(registration.dependencyTypes.size()) });
+			for (std::size_t dependencyType : registration.dependencyTypes) {
+				injector.dependencies.push_back(injector.byType[dependencyType]);
+			}
+		}
+
+		// Singletons are created up front, dependencies first, so resolving one is a single load.
+		injector.singletons.resize(registrations.size());
+		std::vector<std::shared_ptr<void>> noScope(registrations.size());
+		injection::ResolveStack stack(injector.dependencies.size());
+		for (std::uint32_t service : order) {
+			if (registrations[service].lifetime == ServiceLifetime::singleton) {
+				injector.singletons[service] = injector.construct(service, noScope, stack);
+			}
+		}
+		return injector;
+	}
+}
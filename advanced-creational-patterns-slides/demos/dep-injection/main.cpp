@@ -3,6 +3,8 @@
 #include "coffee-machine.h"
 #include "icoffee-service.h"
 
+using namespace dependencyInjectionDemo;
+
 //Step 5
 /*
 Now let's see a simple example of dependency injection over in the main.cpp file.
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../../bench/bench-util.h"
+#include "async-coffee-service.h"
+#include "coffee-machine.h"
+#include "simple-coffee-service.h"
+
+using namespace dependencyInjectionDemo;
+
+/*
+Brew throughput with metrics sent synchronously vs through AsyncCoffeeService.
+
+Build:
+	g++ -std=c++17 -O2 -pthread metrics-benchmark.cpp coffee-machine.cpp simple-coffee-service.cpp async-coffee-service.cpp -o metrics-benchmark
+
+Every machine's "Brewing coffee!" line is silenced in all runs, so the difference between the
+rows is the metrics path alone:
+	- SimpleCoffeeService: formats a line for std::cout (silenced, so no I/O at all - a lower bound).
+	- a synchronous file service: one line per brew, written and flushed to a file under a lock,
+	  which is what a naive metrics client does.
+	- AsyncCoffeeService: a ring buffer push per brew, batches written in the background.
+*/
+
+namespace {
+	const char* syncMetricsPath = "metrics-benchmark-sync.log";
+	const char* asyncMetricsPath = "metrics-benchmark-async.log";
+
+	class SyncFileCoffeeService : public ICoffeeService {
+		std::mutex mutex;
+		std::ofstream file;
+
+		public:
+			explicit SyncFileCoffeeService(const char* path) : file(path, std::ios::trunc) {}
+
+			void sendMetrics() override {
+				std::lock_guard<std::mutex> lock(mutex);
+				file << "Sending metrics!\n";
+				file.flush();
+			}
+	};
+
+	// Each thread brews "brewsPerThread" coffees on its own machine; returns the wall time.
+	double brewOn(ICoffeeService& service, unsigned threads, long brewsPerThread) {
+		std::vector<std::thread> brewers;
+		bench::Clock::time_point start = bench::Clock::now();
+		for (unsigned t = 0; t < threads; t++) {
+			brewers.emplace_back([&service, brewsPerThread] {
+				CoffeeMachine machine(service); // every thread's machine borrows the same service
+				for (long i = 0; i < brewsPerThread; i++) {
+					machine.brew();
+				}
+			});
+		}
+		for (std::thread& brewer : brewers) {
+			brewer.join();
+		}
+		return bench::secondsSince(start);
+	}
+}
+
+int main() {
+	const long brewsPerThread = 1000000;
+	unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+
+	bool ok = true;
+	for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+		double brews = double(brewsPerThread) * threads;
+		std::string suffix = " x" + std::to_string(threads) + " threads";
+
+		bench::SilenceStdout silence;
+
+		SimpleCoffeeService simple;
+		bench::report(("brew, SimpleCoffeeService (cout)" + suffix).c_str(), brews, brewOn(simple, threads, brewsPerThread));
+
+		SyncFileCoffeeService syncFile(syncMetricsPath);
+		bench::report(("brew, synchronous file metrics" + suffix).c_str(), brews, brewOn(syncFile, threads, brewsPerThread));
+
+		std::remove(asyncMetricsPath);
+		AsyncCoffeeService async(asyncMetricsPath);
+		double seconds = brewOn(async, threads, brewsPerThread);
+		bench::report(("brew, AsyncCoffeeService" + suffix).c_str(), brews, seconds);
+
+		// Include the time it takes the background thread to catch up.
+		bench::Clock::time_point flushStart = bench::Clock::now();
+		async.flush();
+		bench::report(("brew, AsyncCoffeeService incl. flush" + suffix).c_str(), brews, seconds + bench::secondsSince(flushStart));
+
+		std::uint64_t recorded = async.recorded();
+		std::uint64_t dropped = async.dropped();
+		std::printf("%-48s %12llu recorded %10llu dropped\n", "", (unsigned long long)recorded, (unsigned long long)dropped);
+		if (recorded + dropped != std::uint64_t(brews)) {
+			std::printf("FAILED: AsyncCoffeeService lost events (%llu + %llu != %.0f)\n",
+				(unsigned long long)recorded, (unsigned long long)dropped, brews);
+			ok = false;
+		}
+	}
+
+	std::remove(syncMetricsPath);
+	std::remove(asyncMetricsPath);
+	return ok ? 0 : 1;
+}
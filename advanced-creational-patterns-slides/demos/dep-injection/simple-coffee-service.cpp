@@ -1,18 +1,18 @@
 #include <iostream>
 #include <memory>
-#include "icoffee-service.h"
+#include "simple-coffee-service.h"
 
-/*Step 4
-Over in the simple‑coffee‑service.cpp file, 
-we've implemented a coffee service type here. 
-This class derives from the icoffee‑service interface 
-and implements the sendMetrics method. 
-*/
+namespace dependencyInjectionDemo {
 
-// Specific implementation of a CoffeeService
-class SimpleCoffeeService : public ICoffeeService {
-	void sendMetrics() override {
+	/*Step 4
+	Over in the simple‑coffee‑service.cpp file, 
+	we've implemented a coffee service type here. 
+	This class derives from the icoffee‑service interface 
+	and implements the sendMetrics method. 
+	*/
+
+	// Specific implementation of a CoffeeService
+	void SimpleCoffeeService::sendMetrics() {
 		std::cout << "Sending metrics!\n";
 	}
-};
-
+}
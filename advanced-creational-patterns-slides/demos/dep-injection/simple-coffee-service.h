@@ -0,0 +1,12 @@
+#pragma once
+
+#include "icoffee-service.h"
+
+namespace dependencyInjectionDemo {
+
+	// Specific implementation of a CoffeeService
+	class SimpleCoffeeService : public ICoffeeService {
+		public:
+			void sendMetrics() override;
+	};
+}
@@ -0,0 +1,116 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "factory-method.h"
+#include "../../bench/alloc-counter.h"
+#include "../../bench/bench-util.h"
+
+using namespace factoryMethodDemo;
+
+/*
+Creation and call cost of the three factory method flavours:
+ - createMachine(int): switch, heap allocation, virtual brew();
+ - createMachine<type>(): concrete type on the stack, direct brew();
+ - createMachineValue(int): std::variant on the stack, brew() through std::visit.
+Machine types come from an array filled at runtime, so the runtime paths can't be constant-folded.
+brew() prints, so std::cout is silenced while we measure.
+*/
+static const int iterations = 10000000;
+
+// A type that isn't built in, registered the way a plugin would register it.
+class DecafCoffeeMachine final : public CoffeeMachine {
+	public:
+		void brew() {
+			std::cout << "Brewing decaf coffee \n";
+		}
+};
+
+static FactoryRegistrar<CoffeeMachine, DecafCoffeeMachine> registerDecaf(CoffeeMachineFactory::registry(), "decaf");
+
+template <typename CreateAndBrew>
+static void run(const char *name, CreateAndBrew createAndBrew) {
+	bench::AllocationStats before = bench::AllocationStats::now();
+	auto start = bench::Clock::now();
+	for (int i = 0; i < iterations; i++) {
+		createAndBrew(i);
+	}
+	double seconds = bench::secondsSince(start);
+	bench::AllocationStats allocations = bench::AllocationStats::now() - before;
+
+	bench::report(name, iterations, seconds);
+	std::printf("%-48s %12.2f allocations/op\n", "", double(allocations.count) / iterations);
+}
+
+int main(int argc, char **) {
+	std::vector<int> machineTypes(1024);
+	for (std::size_t i = 0; i < machineTypes.size(); i++) {
+		machineTypes[i] = 1 + static_cast<int>((i * 7 + argc) % 2);
+	}
+	CoffeeMachineFactory factory;
+	bench::SilenceStdout silence;
+
+	// Creation only.
+	run("create: createMachine(int) heap", [&](int i) {
+		auto machine = factory.createMachine(machineTypes[i & 1023]);
+		bench::doNotOptimize(machine);
+	});
+	run("create: createMachineValue(int) variant", [&](int i) {
+		auto machine = CoffeeMachineFactory::createMachineValue(machineTypes[i & 1023]);
+		bench::doNotOptimize(machine);
+	});
+	run("create: createMachine<2>() stack", [&](int) {
+		auto machine = CoffeeMachineFactory::createMachine<2>();
+		bench::doNotOptimize(machine);
+	});
+
+	// Creation plus a brew() call.
+	run("create + brew: createMachine(int) virtual", [&](int i) {
+		factory.createMachine(machineTypes[i & 1023])->brew();
+	});
+	run("create + brew: createMachineValue(int) visit", [&](int i) {
+		auto machine = CoffeeMachineFactory::createMachineValue(machineTypes[i & 1023]);
+		CoffeeMachineFactory::brew(machine);
+	});
+	run("create + brew: createMachine<2>() direct", [&](int) {
+		CoffeeMachineFactory::createMachine<2>().brew();
+	});
+
+	// Name -> object, as from an order message. The baseline is the usual unordered_map of creators.
+	std::unordered_map<std::string, std::unique_ptr<CoffeeMachine> (*)()> namedCreators = {
+		{ "simple", &createProduct<CoffeeMachine, SimpleCoffeeMachine> },
+		{ "robust", &createProduct<CoffeeMachine, RobustCoffeeMachine> },
+		{ "decaf", &createProduct<CoffeeMachine, DecafCoffeeMachine> },
+	};
+	std::vector<std::string_view> builtInNames(1024), registeredNames(1024, "decaf");
+	for (std::size_t i = 0; i < builtInNames.size(); i++) {
+		builtInNames[i] = machineTypes[i] == 2 ? "robust" : "simple";
+	}
+
+	run("by name: unordered_map<std::string>", [&](int i) {
+		auto machine = namedCreators.at(std::string(builtInNames[i & 1023]))();
+		bench::doNotOptimize(machine);
+	});
+	run("by name: built-in perfect hash", [&](int i) {
+		auto machine = factory.createMachine(builtInNames[i & 1023]);
+		bench::doNotOptimize(machine);
+	});
+	run("by name: runtime-registered fallback", [&](int i) {
+		auto machine = factory.createMachine(registeredNames[i & 1023]);
+		bench::doNotOptimize(machine);
+	});
+
+	try {
+		factory.createMachine(std::string_view("lungo"));
+		std::printf("FAILED: an unknown machine name was accepted\n");
+		return EXIT_FAILURE;
+	} catch (const std::invalid_argument &) {
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -1,62 +1,11 @@
 #include <iostream>
 #include <memory>
+#include "factory-method.h"
 
-//This is the Abstract base class.
-class CoffeeMachine {
-	public:
-		virtual void brew() = 0;
-};
- 
-class SimpleCoffeeMachine: public CoffeeMachine {
-	public:
-		void brew() {
-			std::cout << "Brewing simple coffee \n";
-		}
-};
- 
-class RobustCoffeeMachine: public CoffeeMachine  {
-	public:
-		void brew() {
-			std::cout << "Brewing robust coffee \n";
-		}
-};
+using namespace factoryMethodDemo;
 
-/*
- This CoffeeMachineFactory class provides our factory method for creating coffee machines.
-*/
-
-// This factory class simply encapsulates the factory method for a CoffeeMachine type.
-class CoffeeMachineFactory {
-	public:
-/*
-This method is called createMachine, and it accepts an integer which corresponds to the type
-of coffee machine you want to create. 
-
-This integer is then fed into a switch statement, which then returns a SMART pointer 
-to the created machine. 
-
-There are several ways to implement a factory method function.
-
-Instead of using a switch statement, for instance, you could use C++ templates 
-alongside a static factory method.Or We can ensure that each type contains its own factory
-method. But the key takeaway here is that the factory method pattern is all about
-providing a single method which is used to create objects.
-
-This method encapsulates the logic for creating new objects, 
-such that the objects in question are NOT created directly 
-by the CLIENT via a CONSTRUCTOR.
-*/
-		std::unique_ptr<CoffeeMachine> createMachine(int machineType) {
-			switch(machineType) {
-				case 1:
-					return std::make_unique<SimpleCoffeeMachine>();
-				case 2:
-					return std::make_unique<RobustCoffeeMachine>();
-				default:
-					return std::make_unique<SimpleCoffeeMachine>();
-			}
-		}
-};
+// The machines and CoffeeMachineFactory live in factory-method.h so that
+// the benchmarks can share them with this demo.
 
 /*
 In the main function, we can see how to use this implementation of the factory method pattern.
@@ -85,5 +34,17 @@ int main()
 	machineOne->brew();
 	machineTwo->brew();
 
+	// By name, as it would arrive in an order message
+	auto machineByName = factory->createMachine("robust");
+	machineByName->brew();
+
+	// The same machines, chosen at compile time and living on the stack
+	auto machineThree = CoffeeMachineFactory::createMachine<2>();
+	machineThree.brew();
+
+	// Chosen at runtime, still on the stack
+	CoffeeMachineFactory::AnyMachine machineFour = CoffeeMachineFactory::createMachineValue(1);
+	CoffeeMachineFactory::brew(machineFour);
+
 	return 0;
 }
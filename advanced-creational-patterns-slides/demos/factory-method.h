@@ -0,0 +1,164 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <variant>
+
+#include "../../common/any-machine.h"
+#include "../../instrumentation/creation-stats.h"
+#include "factory-registry.h"
+
+namespace factoryMethodDemo {
+
+	//This is the Abstract base class.
+	class CoffeeMachine {
+		public:
+			virtual void brew() = 0;
+			virtual ~CoffeeMachine() = default;
+	};
+
+	//The concrete machines are "final", so whenever the compiler knows it is holding one,
+	//it can call brew() directly instead of going through the vtable.
+	class SimpleCoffeeMachine final : public CoffeeMachine {
+		public:
+			void brew() {
+				std::cout << "Brewing simple coffee \n";
+			}
+	};
+
+	class RobustCoffeeMachine final : public CoffeeMachine  {
+		public:
+			void brew() {
+				std::cout << "Brewing robust coffee \n";
+			}
+	};
+
+	// A machine held by value, inside the handle when it is small enough (see common/any-machine.h).
+	using AnyCoffeeMachine = BasicAnyCoffeeMachine<CoffeeMachine>;
+
+	/*
+	 This CoffeeMachineFactory class provides our factory method for creating coffee machines.
+	*/
+
+	// This factory class simply encapsulates the factory method for a CoffeeMachine type.
+	class CoffeeMachineFactory {
+		public:
+	/*
+	This method is called createMachine, and it accepts an integer which corresponds to the type
+	of coffee machine you want to create. 
+
+	This integer is then fed into a switch statement, which then returns a SMART pointer 
+	to the created machine. 
+
+	There are several ways to implement a factory method function.
+
+	Instead of using a switch statement, for instance, you could use C++ templates 
+	alongside a static factory method.Or We can ensure that each type contains its own factory
+	method. But the key takeaway here is that the factory method pattern is all about
+	providing a single method which is used to create objects.
+
+	This method encapsulates the logic for creating new objects, 
+	such that the objects in question are NOT created directly 
+	by the CLIENT via a CONSTRUCTOR.
+	*/
+			std::unique_ptr<CoffeeMachine> createMachine(int machineType) {
+				switch(machineType) {
+					case 1: {
+						RECORD_CREATION("CoffeeMachineFactory::createMachine", "SimpleCoffeeMachine");
+						return std::make_unique<SimpleCoffeeMachine>();
+					}
+					case 2: {
+						RECORD_CREATION("CoffeeMachineFactory::createMachine", "RobustCoffeeMachine");
+						return std::make_unique<RobustCoffeeMachine>();
+					}
+					default: {
+						RECORD_CREATION("CoffeeMachineFactory::createMachine", "SimpleCoffeeMachine");
+						return std::make_unique<SimpleCoffeeMachine>();
+					}
+				}
+			}
+
+	/*
+	When the machine type is known at compile time we can do better, exactly as the comment above
+	suggests: a template alongside a static factory method. createMachine<2>() returns the concrete
+	RobustCoffeeMachine by value - it lives on the stack, nothing is heap-allocated, and brew()
+	is an ordinary direct call the compiler can inline.
+	*/
+			template <int machineType>
+			static auto createMachine() {
+				if constexpr (machineType == 2) {
+					RECORD_CREATION("CoffeeMachineFactory::createMachine<>", "RobustCoffeeMachine");
+					return RobustCoffeeMachine();
+				} else {
+					RECORD_CREATION("CoffeeMachineFactory::createMachine<>", "SimpleCoffeeMachine");
+					return SimpleCoffeeMachine();
+				}
+			}
+
+	/*
+	When the type is only known at runtime but the set of types is fixed, createMachineValue()
+	returns a std::variant instead of a heap object. It still lives on the stack, and brew()
+	dispatches through std::visit, which the compiler turns into a jump over the known types
+	rather than a vtable lookup. Unknown codes fall back to SimpleCoffeeMachine, like createMachine().
+	*/
+			using AnyMachine = std::variant<SimpleCoffeeMachine, RobustCoffeeMachine>;
+
+			static AnyMachine createMachineValue(int machineType) {
+				switch(machineType) {
+					case 2: {
+						RECORD_CREATION("CoffeeMachineFactory::createMachineValue", "RobustCoffeeMachine");
+						return RobustCoffeeMachine();
+					}
+					default: {
+						RECORD_CREATION("CoffeeMachineFactory::createMachineValue", "SimpleCoffeeMachine");
+						return SimpleCoffeeMachine();
+					}
+				}
+			}
+
+			static void brew(AnyMachine &machine) {
+				std::visit([](auto &concrete) { concrete.brew(); }, machine);
+			}
+
+	/*
+	When the set of types has to stay open, createAnyMachine() returns an AnyCoffeeMachine instead:
+	any CoffeeMachine, called through the vtable as usual, but stored inside the handle rather than
+	on the heap. Unknown codes fall back to SimpleCoffeeMachine, like createMachine().
+	*/
+			static AnyCoffeeMachine createAnyMachine(int machineType) {
+				switch(machineType) {
+					case 2: {
+						RECORD_CREATION("CoffeeMachineFactory::createAnyMachine", "RobustCoffeeMachine");
+						return RobustCoffeeMachine();
+					}
+					default: {
+						RECORD_CREATION("CoffeeMachineFactory::createAnyMachine", "SimpleCoffeeMachine");
+						return SimpleCoffeeMachine();
+					}
+				}
+			}
+
+	/*
+	Creating machines from their type names, as they arrive in order messages.
+	The built-in names are hashed into a perfect hash table at compile time; other types can be
+	registered at runtime, for example with a FactoryRegistrar (see factory-registry.h).
+	Unlike the int version, an unknown name is an error: it throws std::invalid_argument.
+	*/
+			static constexpr PerfectHashCreators<CoffeeMachine, 2> builtInMachines{ {{
+				{ "simple", &createProduct<CoffeeMachine, SimpleCoffeeMachine> },
+				{ "robust", &createProduct<CoffeeMachine, RobustCoffeeMachine> },
+			}} };
+
+			using Registry = FactoryRegistry<CoffeeMachine, 2>;
+
+			static Registry &registry() {
+				static Registry machines(builtInMachines);
+				return machines;
+			}
+
+			std::unique_ptr<CoffeeMachine> createMachine(std::string_view machineName) {
+				RECORD_CREATION("CoffeeMachineFactory::createMachine", "by name");
+				return registry().create(machineName);
+			}
+	};
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace factoryMethodDemo {
+
+	/*
+	Creating products from their type names, e.g. "robust" in an incoming order message.
+
+	Built-in types live in a PerfectHashCreators table that is computed entirely at compile time:
+	the constructor searches for a hash seed under which no two built-in names collide, so a lookup
+	is one hash, one slot and one string compare - no probing, no allocation.
+	Types added at runtime (plugins, tests) go into a FactoryRegistry's fallback map instead.
+	*/
+
+	template <typename Product>
+	using ProductCreator = std::unique_ptr<Product> (*)();
+
+	template <typename Product, typename Concrete>
+	std::unique_ptr<Product> createProduct() {
+		return std::make_unique<Concrete>();
+	}
+
+	template <typename Product>
+	struct NamedCreator {
+		std::string_view name;
+		ProductCreator<Product> create;
+	};
+
+	// FNV-1a, with the seed mixed into the starting state.
+	constexpr std::uint64_t hashTypeName(std::string_view name, std::uint64_t seed) {
+		std::uint64_t hash = 14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+		for (char c : name) {
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash ^ (hash >> 29);
+	}
+
+	constexpr std::size_t perfectHashTableSize(std::size_t count) {
+		std::size_t size = 1;
+		while (size < 2 * count) {
+			size *= 2;
+		}
+		return size;
+	}
+
+	template <typename Product, std::size_t N>
+	class PerfectHashCreators {
+		static constexpr std::size_t tableSize = perfectHashTableSize(N);
+
+		std::array<NamedCreator<Product>, N> creators;
+		std::array<std::size_t, tableSize> slots; // index into "creators" plus one, 0 means empty
+		std::uint64_t seed;
+
+		public:
+			// Fails to compile if two built-ins share a name.
+			constexpr explicit PerfectHashCreators(std::array<NamedCreator<Product>, N> builtIns)
+				: creators(builtIns), slots{}, seed(0) {
+				for (std::size_t i = 0; i < N; i++) {
+					for (std::size_t j = i + 1; j < N; j++) {
+						if (creators[i].name == creators[j].name) {
+							throw std::logic_error("PerfectHashCreators: duplicate built-in type name");
+						}
+					}
+				}
+
+				for (;; seed++) {
+					bool collided = false;
+					for (std::size_t &slot : slots) {
+						slot = 0;
+					}
+					for (std::size_t i = 0; i < N && !collided; i++) {
+						std::size_t slot = hashTypeName(creators[i].name, seed) & (tableSize - 1);
+						collided = slots[slot] != 0;
+						slots[slot] = i + 1;
+					}
+					if (!collided) {
+						return;
+					}
+				}
+			}
+
+			// Returns nullptr for a name that isn't built in.
+			constexpr ProductCreator<Product> find(std::string_view name) const {
+				std::size_t slot = slots[hashTypeName(name, seed) & (tableSize - 1)];
+				if (slot != 0 && creators[slot - 1].name == name) {
+					return creators[slot - 1].create;
+				}
+				return nullptr;
+			}
+	};
+
+	// The same FNV-1a hash as the built-ins, for the hash map of runtime-registered names.
+	struct TypeNameHash {
+		std::size_t operator()(std::string_view name) const {
+			return static_cast<std::size_t>(hashTypeName(name, 0));
+		}
+	};
+
+	/*
+	The full name-to-product factory: the compile-time built-ins, plus a hash map for types
+	registered at runtime. Registering is thread-safe and may happen at any time; it takes a write
+	lock on the map, which readers only ever touch for names that aren't built in.
+
+	The map is keyed by string_view, so a lookup hashes the caller's name as is - C++17's
+	unordered_map can't look up a std::string key by string_view without building a string first.
+	The registered names themselves live in a deque, which never moves its elements.
+	*/
+	template <typename Product, std::size_t N>
+	class FactoryRegistry {
+		public:
+			using Creator = std::function<std::unique_ptr<Product>()>;
+
+		private:
+			const PerfectHashCreators<Product, N> &builtIns;
+
+			mutable std::shared_mutex registeredMutex;
+			std::deque<std::string> registeredNames;
+			std::unordered_map<std::string_view, Creator, TypeNameHash> registered;
+
+		public:
+			explicit FactoryRegistry(const PerfectHashCreators<Product, N> &builtIns) : builtIns(builtIns) {}
+
+			FactoryRegistry(const FactoryRegistry &) = delete;
+			FactoryRegistry &operator=(const FactoryRegistry &) = delete;
+
+			// Throws std::invalid_argument if the name is already taken, by a built-in or a registered type.
+			void add(std::string name, Creator creator) {
+				if (builtIns.find(name)) {
+					throw std::invalid_argument("FactoryRegistry: \"" + name + "\" is a built-in type");
+				}
+				std::unique_lock<std::shared_mutex> lock(registeredMutex);
+				if (registered.find(name) != registered.end()) {
+					throw std::invalid_argument("FactoryRegistry: \"" + name + "\" is already registered");
+				}
+				registeredNames.push_back(std::move(name));
+				try {
+					registered.emplace(registeredNames.back(), std::move(creator));
+				} catch (...) {
+					registeredNames.pop_back();
+					throw;
+				}
+			}
+
+			bool contains(std::string_view name) const {
+				if (builtIns.find(name)) {
+					return true;
+				}
+				std::shared_lock<std::shared_mutex> lock(registeredMutex);
+				return registered.find(name) != registered.end();
+			}
+
+			// Unknown names are an error: throws std::invalid_argument rather than guessing a type.
+			std::unique_ptr<Product> create(std::string_view name) const {
+				if (ProductCreator<Product> builtIn = builtIns.find(name)) {
+					return builtIn();
+				}
+
+				// Types are never unregistered and rehashing doesn't move map nodes, so the creator stays valid after unlocking.
+				const Creator *creator = nullptr;
+				{
+					std::shared_lock<std::shared_mutex> lock(registeredMutex);
+					auto found = registered.find(name);
+					if (found == registered.end()) {
+						throw std::invalid_argument("FactoryRegistry: unknown type \"" + std::string(name) + "\"");
+					}
+					creator = &found->second;
+				}
+				return (*creator)();
+			}
+	};
+
+	/*
+	Self-registration: define one of these at namespace scope next to a new product type,
+	and the type is registered before main() runs.
+
+		static FactoryRegistrar<CoffeeMachine, EspressoMachine> registerEspresso(CoffeeMachineFactory::registry(), "espresso");
+	*/
+	template <typename Product, typename Concrete>
+	struct FactoryRegistrar {
+		template <typename Registry>
+		FactoryRegistrar(Registry &registry, std::string name) {
+			registry.add(std::move(name), [] { return std::unique_ptr<Product>(std::make_unique<Concrete>()); });
+		}
+	};
+}
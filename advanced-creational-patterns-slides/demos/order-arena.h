@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace abstractFactoryDemo {
+
+	// Destroys an object made in an OrderArena. Its memory stays with the arena until the arena is released.
+	struct ArenaDeleter {
+		template <typename T>
+		void operator()(T *object) const {
+			object->~T();
+		}
+	};
+
+	template <typename T>
+	using ArenaPtr = std::unique_ptr<T, ArenaDeleter>;
+
+	/*
+	A monotonic arena for everything one request creates.
+
+	Objects are bump-allocated from an inline buffer, spilling over to the heap only if a request
+	needs more than "inlineBytes". Nothing is freed individually: ArenaPtr only runs destructors,
+	and the memory comes back all at once when the arena is destroyed or release()d.
+	Reuse one arena per worker thread and release() it between requests to keep the heap out of
+	the request path entirely.
+	*/
+	class OrderArena {
+		static constexpr std::size_t inlineBytes = 1024;
+
+		alignas(std::max_align_t) std::byte buffer[inlineBytes];
+		std::pmr::monotonic_buffer_resource resource{ buffer, sizeof(buffer) };
+
+		public:
+			OrderArena() = default;
+			OrderArena(const OrderArena &) = delete;
+			OrderArena &operator=(const OrderArena &) = delete;
+
+			template <typename T, typename... Args>
+			ArenaPtr<T> make(Args &&...args) {
+				void *memory = resource.allocate(sizeof(T), alignof(T));
+				return ArenaPtr<T>(new (memory) T(std::forward<Args>(args)...));
+			}
+
+			// Makes all of the arena's memory available again. Every object made in it must be gone by now.
+			void release() { resource.release(); }
+
+			std::pmr::memory_resource &memoryResource() { return resource; }
+	};
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "abstract-factory.h"
+#include "order-pipeline.h"
+#include "../../bench/bench-util.h"
+
+using namespace abstractFactoryDemo;
+
+/*
+Load generator for OrderPipeline.
+
+A fixed set of producer threads submits orders for alternating simple and robust families as
+fast as the pipeline accepts them. We repeat with 1, 2, 4, ... workers up to the core count
+(at least 4) and report orders/sec, how often producers hit backpressure, and the per-stage
+latency percentiles.
+*/
+static const int ordersPerProducer = 200000;
+static const int producers = 2;
+
+static void printStage(const char *stage, const LatencyHistogram &histogram) {
+	std::printf("    %-12s p50 <= %8llu ns   p99 <= %8llu ns   p99.9 <= %8llu ns\n", stage,
+		static_cast<unsigned long long>(histogram.percentile(50)),
+		static_cast<unsigned long long>(histogram.percentile(99)),
+		static_cast<unsigned long long>(histogram.percentile(99.9)));
+}
+
+int main() {
+	SimpleCoffeeFactory simpleFactory;
+	RobustCoffeeFactory robustFactory;
+	bench::SilenceStdout silence;
+
+	unsigned maxWorkers = std::max(4u, std::thread::hardware_concurrency());
+	for (unsigned workers = 1; workers <= maxWorkers; workers *= 2) {
+		OrderPipeline pipeline(workers, 1024);
+
+		auto start = bench::Clock::now();
+		std::vector<std::thread> threads;
+		for (int p = 0; p < producers; p++) {
+			threads.emplace_back([&] {
+				for (int i = 0; i < ordersPerProducer; i++) {
+					pipeline.submit(i & 1 ? static_cast<CoffeeFactory &>(robustFactory) : simpleFactory);
+				}
+			});
+		}
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+		pipeline.drain();
+		double seconds = bench::secondsSince(start);
+
+		const OrderPipeline::Stats &stats = pipeline.statistics();
+		char label[96];
+		std::snprintf(label, sizeof(label), "pipeline, %u workers", workers);
+		bench::report(label, double(producers) * ordersPerProducer, seconds);
+		std::printf("    backpressure waits: %llu\n", static_cast<unsigned long long>(stats.backpressureWaits.load()));
+		printStage("queue wait", stats.queueWait);
+		printStage("brew", stats.brewStage);
+		printStage("stir", stats.stirStage);
+		printStage("end to end", stats.endToEnd);
+
+		if (pipeline.completed() != std::uint64_t(producers) * ordersPerProducer || pipeline.failed() != 0) {
+			std::printf("FAILED: every order should have been completed, and none should have failed\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,485 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "abstract-factory.h"
+
+namespace abstractFactoryDemo {
+
+	/*
+	A bounded multi-producer/multi-consumer queue (Dmitry Vyukov's ring buffer).
+	Every cell carries a sequence number that says whose turn it is - a producer's or a consumer's -
+	so pushes and pops only contend on their own counter and never take a lock.
+	tryPush() fails when the queue is full: that is where backpressure comes from.
+	*/
+	template <typename T>
+	class BoundedQueue {
+		struct Cell {
+			std::atomic<std::size_t> sequence;
+			T value;
+		};
+
+		std::unique_ptr<Cell[]> cells;
+		std::size_t mask;
+		alignas(64) std::atomic<std::size_t> enqueuePosition{ 0 };
+		alignas(64) std::atomic<std::size_t> dequeuePosition{ 0 };
+
+		public:
+			// The capacity is rounded up to a power of two.
+			explicit BoundedQueue(std::size_t capacity) {
+				std::size_t size = 2;
+				while (size < capacity) {
+					size *= 2;
+				}
+				cells = std::make_unique<Cell[]>(size);
+				mask = size - 1;
+				for (std::size_t i = 0; i < size; i++) {
+					cells[i].sequence.store(i, std::memory_order_relaxed);
+				}
+			}
+
+			bool tryPush(T &value) {
+				std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+				for (;;) {
+					Cell &cell = cells[position & mask];
+					std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+					std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+					if (difference == 0) {
+						if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+							cell.value = std::move(value);
+							cell.sequence.store(position + 1, std::memory_order_release);
+							return true;
+						}
+					} else if (difference < 0) {
+						return false; // full
+					} else {
+						position = enqueuePosition.load(std::memory_order_relaxed);
+					}
+				}
+			}
+
+			bool tryPop(T &value) {
+				std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+				for (;;) {
+					Cell &cell = cells[position & mask];
+					std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+					std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+					if (difference == 0) {
+						if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+							value = std::move(cell.value);
+							cell.sequence.store(position + mask + 1, std::memory_order_release);
+							return true;
+						}
+					} else if (difference < 0) {
+						return false; // empty
+					} else {
+						position = dequeuePosition.load(std::memory_order_relaxed);
+					}
+				}
+			}
+	};
+
+	/*
+	A latency histogram with one bucket per power of two nanoseconds.
+	Coarse, but recording is a single relaxed increment and it covers nanoseconds to minutes.
+	*/
+	class LatencyHistogram {
+		static constexpr int bucketCount = 64;
+		std::atomic<std::uint64_t> buckets[bucketCount] = {};
+
+		static int bucketFor(std::uint64_t nanoseconds) {
+			int bucket = 0;
+			while (nanoseconds > 1 && bucket < bucketCount - 1) {
+				nanoseconds >>= 1;
+				bucket++;
+			}
+			return bucket;
+		}
+
+		public:
+			void record(std::chrono::steady_clock::duration elapsed) {
+				auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+				buckets[bucketFor(static_cast<std::uint64_t>(std::max<long long>(nanoseconds, 0)))].fetch_add(1, std::memory_order_relaxed);
+			}
+
+			std::uint64_t count() const {
+				std::uint64_t total = 0;
+				for (const auto &bucket : buckets) {
+					total += bucket.load(std::memory_order_relaxed);
+				}
+				return total;
+			}
+
+			// Upper bound, in nanoseconds, of the bucket holding the given percentile (0-100).
+			std::uint64_t percentile(double percent) const {
+				std::uint64_t total = count();
+				std::uint64_t wanted = static_cast<std::uint64_t>(total * percent / 100.0);
+				std::uint64_t seen = 0;
+				for (int bucket = 0; bucket < bucketCount; bucket++) {
+					seen += buckets[bucket].load(std::memory_order_relaxed);
+					if (seen > wanted) {
+						return std::uint64_t(2) << bucket;
+					}
+				}
+				return 0;
+			}
+	};
+
+	/*
+	A work-stealing thread pool.
+
+	Every worker has its own deque. Tasks a worker submits go onto its own deque, and it takes its
+	newest task first, which keeps related work (like the stages of one order) on one core while it
+	is still in cache. A worker with nothing to do steals the oldest task from another worker, and
+	only then asks the "idle" hook for new work from outside the pool.
+
+	Tasks must not throw: as on any other thread, an exception escaping one ends the program.
+	*/
+	class WorkStealingPool {
+		public:
+			using Task = std::function<void()>;
+			// Called by a worker that found nothing to run. Returns true if it did some work.
+			using IdleHook = std::function<bool()>;
+
+		private:
+			struct alignas(64) Worker {
+				std::mutex mutex;
+				std::deque<Task> tasks;
+			};
+
+			std::vector<std::unique_ptr<Worker>> workers;
+			std::vector<std::thread> threads;
+			IdleHook idle;
+
+			std::atomic<bool> stopping{ false };
+			std::mutex sleepMutex;
+			std::condition_variable wakeUp;
+			std::atomic<std::size_t> nextWorker{ 0 };
+
+			static int &currentWorker() {
+				thread_local int index = -1;
+				return index;
+			}
+
+			bool popLocal(std::size_t self, Task &task) {
+				Worker &worker = *workers[self];
+				std::lock_guard<std::mutex> lock(worker.mutex);
+				if (worker.tasks.empty()) {
+					return false;
+				}
+				task = std::move(worker.tasks.back());
+				worker.tasks.pop_back();
+				return true;
+			}
+
+			bool steal(std::size_t self, Task &task) {
+				for (std::size_t offset = 1; offset < workers.size(); offset++) {
+					Worker &victim = *workers[(self + offset) % workers.size()];
+					std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+					if (lock.owns_lock() && !victim.tasks.empty()) {
+						task = std::move(victim.tasks.front());
+						victim.tasks.pop_front();
+						return true;
+					}
+				}
+				return false;
+			}
+
+			void stop() {
+				stopping.store(true, std::memory_order_release);
+				wakeUp.notify_all();
+				for (std::thread &thread : threads) {
+					thread.join();
+				}
+			}
+
+			void run(std::size_t self) {
+				currentWorker() = static_cast<int>(self);
+				int idleRounds = 0;
+				while (!stopping.load(std::memory_order_acquire)) {
+					Task task;
+					if (popLocal(self, task) || steal(self, task)) {
+						task();
+						idleRounds = 0;
+					} else if (idle && idle()) {
+						idleRounds = 0;
+					} else if (++idleRounds < 64) {
+						std::this_thread::yield();
+					} else {
+						std::unique_lock<std::mutex> lock(sleepMutex);
+						wakeUp.wait_for(lock, std::chrono::microseconds(200));
+					}
+				}
+			}
+
+		public:
+			WorkStealingPool(std::size_t workerCount, IdleHook idle) : idle(std::move(idle)) {
+				workerCount = std::max<std::size_t>(workerCount, 1);
+				for (std::size_t i = 0; i < workerCount; i++) {
+					workers.push_back(std::make_unique<Worker>());
+				}
+				try {
+					for (std::size_t i = 0; i < workerCount; i++) {
+						threads.emplace_back(&WorkStealingPool::run, this, i);
+					}
+				} catch (...) {
+					// No destructor runs for a pool that failed to construct: stop the workers already started here.
+					stop();
+					throw;
+				}
+			}
+
+			~WorkStealingPool() { stop(); }
+
+			WorkStealingPool(const WorkStealingPool &) = delete;
+			WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+			// From a worker, the task goes onto that worker's own deque; from outside, round-robin.
+			void submit(Task task) {
+				int self = currentWorker();
+				std::size_t target = self >= 0 ? static_cast<std::size_t>(self) : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+				{
+					std::lock_guard<std::mutex> lock(workers[target]->mutex);
+					workers[target]->tasks.push_back(std::move(task));
+				}
+				if (self < 0) {
+					wakeUp.notify_one();
+				}
+			}
+
+			// Wakes a sleeping worker, e.g. because new work is waiting behind the idle hook.
+			void notify() { wakeUp.notify_one(); }
+
+			std::size_t size() const { return workers.size(); }
+	};
+
+	/*
+	The order engine: a bounded order queue feeding a two-stage pipeline on a work-stealing pool.
+
+	Producers submit() orders. Idle workers take them off the queue, build the product family with
+	the order's CoffeeFactory, brew, and hand the stir stage back to the pool as a separate task -
+	so under load, stirring one order overlaps with brewing the next on other cores.
+	If the workers fall behind, the queue fills up and submit() waits: backpressure, instead of an
+	unbounded backlog.
+
+	An order whose factory, machine or coffee throws still counts as completed, so drain() never
+	waits for it; failed() counts those orders, and drain() rethrows the first of their exceptions.
+	*/
+	class OrderPipeline {
+		public:
+			struct Order {
+				CoffeeFactory *factory = nullptr;
+				std::chrono::steady_clock::time_point submitted;
+			};
+
+			struct Stats {
+				LatencyHistogram queueWait;  // submit() until a worker picks the order up
+				LatencyHistogram brewStage;  // building the family and brewing
+				LatencyHistogram stirStage;  // end of brewing until stirring is done, including the handoff
+				LatencyHistogram endToEnd;   // submit() until stirring is done
+				std::atomic<std::uint64_t> backpressureWaits{ 0 };
+			};
+
+		private:
+			// An order moves between stages - and threads - so its products live on the heap, not in a worker's arena.
+			struct InFlight {
+				std::unique_ptr<CoffeeMachine> machine;
+				std::unique_ptr<Coffee> coffee;
+				std::chrono::steady_clock::time_point submitted;
+				std::chrono::steady_clock::time_point brewed;
+			};
+
+			BoundedQueue<Order> queue;
+			Stats stats;
+			std::atomic<std::uint64_t> submittedOrders{ 0 };
+			std::atomic<std::uint64_t> completedOrders{ 0 };
+			std::atomic<std::uint64_t> failedOrders{ 0 };
+			std::mutex errorMutex;
+			std::exception_ptr firstError;
+
+			// Producers blocked on a full queue sleep here; a worker that frees a slot wakes them.
+			std::atomic<int> producersWaiting{ 0 };
+			std::mutex spaceMutex;
+			std::condition_variable spaceAvailable;
+
+			WorkStealingPool pool; // last, so it stops before the rest is destroyed
+
+			/*
+			Order records are recycled through a free list per thread, like MachinePool's storage:
+			the worker that stirs an order keeps its record for the next order it takes. Every worker
+			both takes orders and stirs them, so no list outgrows the orders in flight. The stir task
+			then captures just two pointers, which std::function stores without allocating.
+			*/
+			static std::vector<std::unique_ptr<InFlight>> &spareRecords() {
+				thread_local std::vector<std::unique_ptr<InFlight>> spare;
+				return spare;
+			}
+
+			static std::unique_ptr<InFlight> takeRecord() {
+				std::vector<std::unique_ptr<InFlight>> &spare = spareRecords();
+				if (spare.empty()) {
+					return std::make_unique<InFlight>();
+				}
+				std::unique_ptr<InFlight> record = std::move(spare.back());
+				spare.pop_back();
+				return record;
+			}
+
+			static void giveBack(std::unique_ptr<InFlight> record) {
+				if (!record) {
+					return;
+				}
+				record->machine.reset();
+				record->coffee.reset();
+				try {
+					spareRecords().push_back(std::move(record));
+				} catch (...) {
+					// No room on the list: the record is simply freed.
+				}
+			}
+
+			void complete(std::exception_ptr error = nullptr) {
+				if (error) {
+					failedOrders.fetch_add(1, std::memory_order_relaxed);
+					std::lock_guard<std::mutex> lock(errorMutex);
+					if (!firstError) {
+						firstError = error;
+					}
+				}
+				completedOrders.fetch_add(1, std::memory_order_release);
+			}
+
+			bool takeOrder() {
+				Order order;
+				if (!queue.tryPop(order)) {
+					return false;
+				}
+				if (producersWaiting.load() > 0) {
+					std::lock_guard<std::mutex> lock(spaceMutex);
+					spaceAvailable.notify_all();
+				}
+
+				auto started = std::chrono::steady_clock::now();
+				stats.queueWait.record(started - order.submitted);
+
+				std::unique_ptr<InFlight> inFlight;
+				try {
+					inFlight = takeRecord();
+					inFlight->submitted = order.submitted;
+					inFlight->machine = order.factory->createMachine();
+					inFlight->coffee = order.factory->createCoffee();
+					inFlight->machine->brew();
+					inFlight->brewed = std::chrono::steady_clock::now();
+					stats.brewStage.record(inFlight->brewed - started);
+
+					InFlight *handoff = inFlight.get();
+					pool.submit([this, handoff] { stir(std::unique_ptr<InFlight>(handoff)); });
+					inFlight.release(); // the stir task owns it now
+				} catch (...) {
+					complete(std::current_exception());
+					giveBack(std::move(inFlight));
+				}
+				return true;
+			}
+
+			void stir(std::unique_ptr<InFlight> inFlight) {
+				std::exception_ptr error;
+				try {
+					inFlight->coffee->stir();
+					auto finished = std::chrono::steady_clock::now();
+					stats.stirStage.record(finished - inFlight->brewed);
+					stats.endToEnd.record(finished - inFlight->submitted);
+				} catch (...) {
+					error = std::current_exception();
+				}
+				giveBack(std::move(inFlight));
+				complete(error);
+			}
+
+			void waitForOrders() {
+				while (completedOrders.load(std::memory_order_acquire) < submittedOrders.load(std::memory_order_relaxed)) {
+					std::this_thread::sleep_for(std::chrono::microseconds(50));
+				}
+			}
+
+		public:
+			OrderPipeline(std::size_t workers, std::size_t queueCapacity)
+				: queue(queueCapacity), pool(workers, [this] { return takeOrder(); }) {}
+
+			// Finishes every order already submitted before shutting the workers down.
+			~OrderPipeline() { waitForOrders(); }
+
+			OrderPipeline(const OrderPipeline &) = delete;
+			OrderPipeline &operator=(const OrderPipeline &) = delete;
+
+			// Thread-safe. Waits while the queue is full.
+			void submit(CoffeeFactory &factory) {
+				Order order{ &factory, std::chrono::steady_clock::now() };
+				submittedOrders.fetch_add(1, std::memory_order_relaxed);
+				if (queue.tryPush(order)) {
+					pool.notify();
+					return;
+				}
+
+				stats.backpressureWaits.fetch_add(1, std::memory_order_relaxed);
+				producersWaiting.fetch_add(1);
+				{
+					// The timeout bounds each sleep in case a wakeup slips in between a failed push and the wait.
+					std::unique_lock<std::mutex> lock(spaceMutex);
+					while (!queue.tryPush(order)) {
+						pool.notify();
+						spaceAvailable.wait_for(lock, std::chrono::microseconds(100));
+					}
+				}
+				producersWaiting.fetch_sub(1);
+				pool.notify();
+			}
+
+			// Tries once; returns false instead of waiting if the queue is full.
+			bool trySubmit(CoffeeFactory &factory) {
+				Order order{ &factory, std::chrono::steady_clock::now() };
+				// Counted before the push, as in submit(), so drain() can't miss an order a worker already finished.
+				submittedOrders.fetch_add(1, std::memory_order_relaxed);
+				if (!queue.tryPush(order)) {
+					submittedOrders.fetch_sub(1, std::memory_order_relaxed);
+					stats.backpressureWaits.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				pool.notify();
+				return true;
+			}
+
+			/*
+			Waits until every order submitted so far has been stirred or has failed, then rethrows
+			the first exception an order threw since the last drain(), if any.
+			*/
+			void drain() {
+				waitForOrders();
+				std::exception_ptr error;
+				{
+					std::lock_guard<std::mutex> lock(errorMutex);
+					std::swap(error, firstError);
+				}
+				if (error) {
+					std::rethrow_exception(error);
+				}
+			}
+
+			const Stats &statistics() const { return stats; }
+			// Every finished order, failed ones included.
+			std::uint64_t completed() const { return completedOrders.load(std::memory_order_acquire); }
+			std::uint64_t failed() const { return failedOrders.load(std::memory_order_relaxed); }
+	};
+}
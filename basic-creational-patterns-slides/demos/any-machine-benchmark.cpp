@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "prototype.h"
+#include "../../bench/alloc-counter.h"
+#include "../../bench/bench-util.h"
+
+using namespace prototypeDemo;
+
+/*
+A fleet of 1M mixed machines held as std::vector<std::unique_ptr<CoffeeMachine>> against
+std::vector<AnyCoffeeMachine>: building it, brewing every machine, and copying it.
+
+Build:
+	g++ -std=c++17 -O2 -pthread any-machine-benchmark.cpp -o any-machine-benchmark
+
+The built-in machines print from brew(), which would drown out everything else, so the fleet
+is made of three small counting machines registered as prototypes next to them. Brewing walks
+the fleet in creation order and again after shuffling it: a unique_ptr fleet then jumps around
+the heap, while the handles carry their machines with them.
+*/
+
+namespace {
+	const std::size_t fleetSize = 1000000;
+	const int brewPasses = 10;
+
+	long brewed[3];
+
+	template <int Kind>
+	class CountingMachine : public Cloneable<CountingMachine<Kind>> {
+		public:
+			void brew() { brewed[Kind]++; }
+	};
+
+	// Too big for the handle, so it goes on the heap.
+	class BigMachine : public SimpleCoffeeMachine {
+		public:
+			char serialNumber[256] = "BIG-0001";
+	};
+
+	template <typename Work>
+	void measure(const char* name, double operations, Work work) {
+		bench::AllocationStats before = bench::AllocationStats::now();
+		bench::Clock::time_point start = bench::Clock::now();
+		work();
+		double seconds = bench::secondsSince(start);
+		bench::AllocationStats used = bench::AllocationStats::now() - before;
+		bench::report(name, operations, seconds);
+		std::printf("%-48s %12.2f allocations/machine\n", "", double(used.count) / fleetSize);
+	}
+
+	template <typename Fleet>
+	void brewAll(Fleet& fleet) {
+		for (int pass = 0; pass < brewPasses; pass++) {
+			for (auto& machine : fleet) {
+				machine->brew();
+			}
+		}
+	}
+
+	bool check(bool ok, const char* what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+		}
+		return ok;
+	}
+}
+
+int main() {
+	CoffeeMachineManager::TypeId kinds[] = {
+		CoffeeMachineManager::registerPrototype("counting-0", std::make_unique<CountingMachine<0>>()),
+		CoffeeMachineManager::registerPrototype("counting-1", std::make_unique<CountingMachine<1>>()),
+		CoffeeMachineManager::registerPrototype("counting-2", std::make_unique<CountingMachine<2>>()),
+	};
+	std::printf("sizeof(AnyCoffeeMachine) = %zu, inline capacity %zu, sizeof(SimpleCoffeeMachine) = %zu\n\n",
+		sizeof(AnyCoffeeMachine), AnyCoffeeMachine::inlineCapacity, sizeof(SimpleCoffeeMachine));
+
+	bool ok = true;
+	for (CoffeeMachineManager::TypeId type : { CoffeeMachineManager::simpleMachine, CoffeeMachineManager::complexMachine, CoffeeMachineManager::espressoMachine }) {
+		ok &= check(CoffeeMachineManager::createAnyMachine(type).isInline(), "a built-in machine was not stored inline");
+	}
+	AnyCoffeeMachine big = BigMachine();
+	AnyCoffeeMachine bigCopy = big;
+	ok &= check(!big.isInline() && bigCopy.get() != big.get() &&
+		std::string(static_cast<BigMachine&>(*bigCopy).serialNumber) == "BIG-0001", "a big machine should be copied on the heap");
+
+	std::vector<std::unique_ptr<CoffeeMachine>> pointers;
+	measure("build: vector<unique_ptr>, createMachine", fleetSize, [&] {
+		pointers.reserve(fleetSize);
+		for (std::size_t i = 0; i < fleetSize; i++) {
+			pointers.emplace_back(CoffeeMachineManager::createMachine(kinds[i % 3]));
+		}
+	});
+
+	std::vector<AnyCoffeeMachine> handles;
+	bench::AllocationStats beforeHandles = bench::AllocationStats::now();
+	measure("build: vector<AnyCoffeeMachine>, createAnyMachine", fleetSize, [&] {
+		handles.reserve(fleetSize);
+		for (std::size_t i = 0; i < fleetSize; i++) {
+			handles.push_back(CoffeeMachineManager::createAnyMachine(kinds[i % 3]));
+		}
+	});
+	ok &= check((bench::AllocationStats::now() - beforeHandles).count <= 1, "the AnyCoffeeMachine fleet allocated more than its vector");
+	std::printf("\n");
+
+	measure("brew: vector<unique_ptr>, creation order", double(fleetSize) * brewPasses, [&] { brewAll(pointers); });
+	measure("brew: vector<AnyCoffeeMachine>, creation order", double(fleetSize) * brewPasses, [&] { brewAll(handles); });
+
+	// The same permutation for both fleets.
+	std::mt19937 shuffleOrder(42);
+	std::shuffle(pointers.begin(), pointers.end(), shuffleOrder);
+	shuffleOrder.seed(42);
+	std::shuffle(handles.begin(), handles.end(), shuffleOrder);
+	measure("brew: vector<unique_ptr>, shuffled", double(fleetSize) * brewPasses, [&] { brewAll(pointers); });
+	measure("brew: vector<AnyCoffeeMachine>, shuffled", double(fleetSize) * brewPasses, [&] { brewAll(handles); });
+	std::printf("\n");
+
+	measure("copy: vector<unique_ptr>, clone() each", fleetSize, [&] {
+		std::vector<std::unique_ptr<CoffeeMachine>> copy;
+		copy.reserve(pointers.size());
+		for (const std::unique_ptr<CoffeeMachine>& machine : pointers) {
+			copy.emplace_back(machine->clone());
+		}
+		bench::doNotOptimize(copy.back());
+	});
+	measure("copy: vector<AnyCoffeeMachine>, copy the vector", fleetSize, [&] {
+		std::vector<AnyCoffeeMachine> copy = handles;
+		bench::doNotOptimize(copy.back());
+	});
+
+	// Four brew runs, each making every machine brew once per pass.
+	for (int kind = 0; kind < 3; kind++) {
+		long machines = long((fleetSize + 2 - kind) / 3);
+		ok &= check(brewed[kind] == machines * brewPasses * 4, "every machine should have brewed once per pass");
+	}
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
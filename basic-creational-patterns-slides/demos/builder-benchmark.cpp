@@ -0,0 +1,98 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../../bench/alloc-counter.h"
+#include "../../bench/bench-util.h"
+#include "builder.h"
+
+using namespace builderDemo;
+
+/*
+Building 10M coffee orders: heap allocations and time per order.
+
+Build:
+	g++ -std=c++17 -O2 builder-benchmark.cpp -o builder-benchmark
+
+The requestor's name is longer than the small-string buffer, so every copy of it is a heap
+allocation; that's what the columns count. A finished order needs exactly one - the Coffee's
+own copy of the name - and the CoffeeOrder paths are checked to need no more than that.
+Orders go into a vector that is cleared every "batchSize" orders, so memory stays flat.
+*/
+
+namespace {
+	const long orderCount = 10000000;
+	const std::size_t batchSize = 1000;
+
+	template <typename PlaceOrder>
+	double run(const char* name, PlaceOrder placeOrder) {
+		std::vector<Coffee> orders;
+		orders.reserve(batchSize);
+
+		bench::AllocationStats before = bench::AllocationStats::now();
+		bench::Clock::time_point start = bench::Clock::now();
+		for (long i = 0; i < orderCount; i++) {
+			placeOrder(orders);
+			if (orders.size() == batchSize) {
+				bench::doNotOptimize(orders.back());
+				orders.clear();
+			}
+		}
+		double seconds = bench::secondsSince(start);
+		bench::AllocationStats used = bench::AllocationStats::now() - before;
+
+		double perOrder = double(used.count) / orderCount;
+		bench::report(name, orderCount, seconds);
+		std::printf("%-48s %12.2f allocations/order %10.1f bytes/order\n", "", perOrder, double(used.bytes) / orderCount);
+		return perOrder;
+	}
+}
+
+int main() {
+	const std::string requestor = "Zachary from accounts, desk 42";
+
+	run("CoffeeBuilder, Coffee c = chain; push_back(c)", [&requestor](std::vector<Coffee>& orders) {
+		Coffee coffee = Coffee::create(requestor).makeHot().addSugar().addMilk().costs(4.00);
+		orders.push_back(coffee);
+	});
+
+	run("CoffeeBuilder, push_back(std::move(c))", [&requestor](std::vector<Coffee>& orders) {
+		Coffee coffee = Coffee::create(requestor).makeHot().addSugar().addMilk().costs(4.00);
+		orders.push_back(std::move(coffee));
+	});
+
+	double built = run("CoffeeOrder, build() then push_back(move)", [&requestor](std::vector<Coffee>& orders) {
+		Coffee coffee = CoffeeOrder(requestor).makeHot().addSugar().addMilk().costs(4.00).build();
+		orders.push_back(std::move(coffee));
+	});
+
+	double emplaced = run("CoffeeOrder, emplaceInto(vector)", [&requestor](std::vector<Coffee>& orders) {
+		CoffeeOrder(requestor).makeHot().addSugar().addMilk().costs(4.00).emplaceInto(orders);
+	});
+
+	// Caller-provided storage: a fixed array of raw slots, reused batch after batch.
+	struct alignas(Coffee) Slot {
+		unsigned char bytes[sizeof(Coffee)];
+	};
+	std::unique_ptr<Slot[]> storage(new Slot[batchSize]);
+	std::size_t used = 0;
+	double placed = run("CoffeeOrder, buildAt(caller storage)", [&](std::vector<Coffee>&) {
+		Coffee* coffee = CoffeeOrder(requestor).makeHot().addSugar().addMilk().costs(4.00).buildAt(&storage[used]);
+		if (++used == batchSize) {
+			for (std::size_t i = 0; i < batchSize; i++) {
+				std::launder(reinterpret_cast<Coffee*>(&storage[i]))->~Coffee();
+			}
+			used = 0;
+		}
+		bench::doNotOptimize(coffee);
+	});
+
+	if (built > 1.0 || emplaced > 1.0 || placed > 1.0) {
+		std::printf("FAILED: a CoffeeOrder should allocate only the Coffee's own name\n");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -1,39 +1,24 @@
 #include "builder.h"
+#include "coffee-recipe.h"
 #include <iostream>
 #include <string>
 
-// Implement the Coffee classes "create" method
-// This method returns an instance of a CoffeeBuilder, which will
-// allow us to build coffees step by step. 
+using namespace builderDemo;
 
-// And below this, we implement all of the buildr methods for each part
-//of the API. Here, we have four methods.
-CoffeeBuilder Coffee::create(std::string requestorName) {
-	return CoffeeBuilder{requestorName};
-}
-
-// Builder methods
-CoffeeBuilder&  CoffeeBuilder::makeHot() {
-	coffee.isHot = true;
-	return *this;
-};
-
-CoffeeBuilder&  CoffeeBuilder::addSugar() {
-	coffee.hasSugar = true;
-	return *this;
-};
-
-CoffeeBuilder&  CoffeeBuilder::addMilk() {
-	coffee.hasMilk = true;
-    return *this;
-};
+// Coffee, CoffeeBuilder and their builder methods live in builder.h so that
+// the benchmarks can share them with this demo.
 
-CoffeeBuilder&  CoffeeBuilder::costs(double cost) {
-    coffee.cost = cost; 
-    return *this;
+// A builder with a couple of steps already taken: every coffee it makes is sweet and white.
+class SweetWhiteBuilder : public CoffeeBuilder
+{
+	public:
+		SweetWhiteBuilder(std::string requestorName) : CoffeeBuilder(std::move(requestorName)) 
+		{
+			addSugar();
+			addMilk();
+		}
 };
 
-
 int main() { 
 	//Here we are building two coffees. 
 	//First, we call this "static create" method with the name
@@ -48,27 +33,8 @@ int main() {
 	//A static member function can be called, 
 	//even when a class is not instantiated.
 
-
-//node 
-//parent
-//left
-
-
-
-
-class SweetWhiteBuilder : public CoffeeBuilder
-{
-SweetWhiteBuilder(std::string requestorName) : CoffeeBuilder(requestorName) 
-{
-	addSugar();
-	addMilk();
-}
-}
-
 	SweetWhiteBuilder  builder("Olaf");
-	class cappucino : public Coffee;
-
-	Coffee coffee = builder;
+	Coffee sweetWhite = builder.costs(3.00);
     
 	Coffee coffee = Coffee::create("Zachary")
 							  .makeHot()
@@ -80,8 +46,22 @@ SweetWhiteBuilder(std::string requestorName) : CoffeeBuilder(requestorName)
 							  .makeHot()
 							  .costs(3.50);
 
+	// The same order through CoffeeOrder: no Coffee exists until build() constructs it right here.
+	Coffee coffee3 = CoffeeOrder("Zachary")
+							  .makeHot()
+							  .addSugar()
+							  .addMilk()
+							  .costs(4.00)
+							  .build();
+
+	// Or a preset from coffee-recipe.h, worked out entirely at compile time.
+	Coffee sweetWhite2 = CoffeeRecipes::sweetWhite.pour("Olaf");
+
+    std::cout << sweetWhite.cost << std::endl;
+    std::cout << sweetWhite2.cost << std::endl;
     std::cout << coffee.cost << std::endl;
     std::cout << coffee2.cost << std::endl;
+    std::cout << coffee3.cost << std::endl;
 
     return 0;
 }
@@ -1,83 +1,207 @@
 #pragma once
 #include <iostream>
+#include <new>
 #include <string>
+#include <string_view>
+#include <utility>
 
-// Forward declare CoffeeBuilder class here to avoid compilation errors
-class CoffeeBuilder;
-
-// Coffee class declaration
-class Coffee {
-	std::string requestorName;
-
-	public:
-		bool isHot;
-		bool hasMilk;
-		bool hasSugar;
-		double cost;
-
-		Coffee(std::string requestorName) : requestorName(requestorName) {}
-
-	  /*We have declared the CoffeeBuilder Class as a friend.
-		A friend class can access private and protected members of other class 
-		in which it is declared as friend.
-		This allows a CoffeeBuilder object to peek into 
-		the internals of the coffee it creates.*/
-		friend class CoffeeBuilder;
-		
-		/*
-		The static member function create() which will return an instance 
-		of a CoffeeBuilder - the class that encapsulates all of the logic 
-		for the step-by-step workflow we want to implement"
-		*/ 
-		static CoffeeBuilder create(std::string requestorName);
-		/*
-		Note:
-		1)
-		A non-static member function can be called only after instantiating 
-		the class as an object. 
-		This is not the case with static member functions. 
-		A static member function can be called, 
-		even when a class is not instantiated.
-		2)
-		A static member function cannot have access to the this pointer 
-		of the class.
-		3)
-		A non-static member function can be declared as virtual 
-		but care must be taken not to declare a static member function 
-		as virtual.
-		4)
-		A static member function can only access static member data,
-		static member functions and data and functions outside the class. 
-		5)
-		It is possible to declare a data member of a class as static irrespective
-		of it being a public or a private type in class definition.
-		If a data is declared as static, then the static data is created 
-		and initialized only once.  
-		*/
-};
-
-// CoffeeBuilder class declaration - responsible for building a Coffee
-class CoffeeBuilder {
-    //CoffeeBuilder creates a basic coffee object.
-	Coffee coffee;
-
-	public:
-		CoffeeBuilder(std::string requestorName) : coffee(Coffee(requestorName)) {}
-
-		/* This operator allows us to convert from a CoffeeBuilder to a Coffee 
-		Function Call Operator () Overloading in C++
-		The operator that will allow for an easy conversion between 
-		the CoffeeBuilder class to the Coffee class.
-		*/
-		
-		/* This will allow us to use the CoffeeBuilder type to build 
-		the Coffee class while hiding away the "CoffeeBuilder" class from
-		the client.
-		*/
-		operator Coffee() const { return std::move(coffee); }
-
-		CoffeeBuilder&  makeHot();
-		CoffeeBuilder&  addMilk();
-		CoffeeBuilder&  addSugar();
-		CoffeeBuilder&  costs(double cost);
-};
+#include "../../instrumentation/creation-stats.h"
+
+namespace builderDemo {
+
+	// Forward declare CoffeeBuilder class here to avoid compilation errors
+	class CoffeeBuilder;
+
+	// Coffee class declaration
+	class Coffee {
+		std::string requestorName;
+
+		public:
+			bool isHot = false;
+			bool hasMilk = false;
+			bool hasSugar = false;
+			double cost = 0;
+
+			Coffee(std::string requestorName) : requestorName(std::move(requestorName)) {}
+
+			// Everything at once, for builders that construct the finished coffee in place.
+			Coffee(std::string requestorName, bool isHot, bool hasMilk, bool hasSugar, double cost)
+				: requestorName(std::move(requestorName)), isHot(isHot), hasMilk(hasMilk), hasSugar(hasSugar), cost(cost) {}
+
+			const std::string& requestor() const { return requestorName; }
+
+		  /*We have declared the CoffeeBuilder Class as a friend.
+			A friend class can access private and protected members of other class 
+			in which it is declared as friend.
+			This allows a CoffeeBuilder object to peek into 
+			the internals of the coffee it creates.*/
+			friend class CoffeeBuilder;
+
+			/*
+			The static member function create() which will return an instance 
+			of a CoffeeBuilder - the class that encapsulates all of the logic 
+			for the step-by-step workflow we want to implement"
+			*/ 
+			static CoffeeBuilder create(std::string requestorName);
+			/*
+			Note:
+			1)
+			A non-static member function can be called only after instantiating 
+			the class as an object. 
+			This is not the case with static member functions. 
+			A static member function can be called, 
+			even when a class is not instantiated.
+			2)
+			A static member function cannot have access to the this pointer 
+			of the class.
+			3)
+			A non-static member function can be declared as virtual 
+			but care must be taken not to declare a static member function 
+			as virtual.
+			4)
+			A static member function can only access static member data,
+			static member functions and data and functions outside the class. 
+			5)
+			It is possible to declare a data member of a class as static irrespective
+			of it being a public or a private type in class definition.
+			If a data is declared as static, then the static data is created 
+			and initialized only once.  
+			*/
+	};
+
+	// CoffeeBuilder class declaration - responsible for building a Coffee
+	class CoffeeBuilder {
+	    //CoffeeBuilder creates a basic coffee object.
+		Coffee coffee;
+
+		public:
+			CoffeeBuilder(std::string requestorName) : coffee(std::move(requestorName)) {}
+
+			/* This operator allows us to convert from a CoffeeBuilder to a Coffee 
+			Function Call Operator () Overloading in C++
+			The operator that will allow for an easy conversion between 
+			the CoffeeBuilder class to the Coffee class.
+			*/
+
+			/* This will allow us to use the CoffeeBuilder type to build 
+			the Coffee class while hiding away the "CoffeeBuilder" class from
+			the client.
+			*/
+			operator Coffee() const & { return coffee; }
+
+			// A builder that is about to go away can hand its coffee over instead of copying it.
+			operator Coffee() && { return std::move(coffee); }
+
+			CoffeeBuilder&  makeHot() &;
+			CoffeeBuilder&  addMilk() &;
+			CoffeeBuilder&  addSugar() &;
+			CoffeeBuilder&  costs(double cost) &;
+
+			// On a temporary, as in "Coffee coffee = Coffee::create(name).makeHot();", the chain
+			// stays an rvalue all the way, so the coffee is moved out at the end instead of copied.
+			CoffeeBuilder&& makeHot() && { return std::move(makeHot()); }
+			CoffeeBuilder&& addMilk() && { return std::move(addMilk()); }
+			CoffeeBuilder&& addSugar() && { return std::move(addSugar()); }
+			CoffeeBuilder&& costs(double cost) && { return std::move(costs(cost)); }
+	};
+
+	// Implement the Coffee classes "create" method
+	// This method returns an instance of a CoffeeBuilder, which will
+	// allow us to build coffees step by step. 
+
+	// And below this, we implement all of the buildr methods for each part
+	//of the API. Here, we have four methods.
+	inline CoffeeBuilder Coffee::create(std::string requestorName) {
+		RECORD_CREATION("Coffee::create", "Coffee");
+		return CoffeeBuilder{std::move(requestorName)};
+	}
+
+	// Builder methods
+	inline CoffeeBuilder&  CoffeeBuilder::makeHot() & {
+		coffee.isHot = true;
+		return *this;
+	}
+
+	inline CoffeeBuilder&  CoffeeBuilder::addSugar() & {
+		coffee.hasSugar = true;
+		return *this;
+	}
+
+	inline CoffeeBuilder&  CoffeeBuilder::addMilk() & {
+		coffee.hasMilk = true;
+	    return *this;
+	}
+
+	inline CoffeeBuilder&  CoffeeBuilder::costs(double cost) & {
+	    coffee.cost = cost; 
+	    return *this;
+	}
+
+	/*
+	A second builder for hot paths, which never holds a Coffee at all.
+
+	CoffeeBuilder carries a whole Coffee through the chain and then copies (or moves) it out.
+	A CoffeeOrder only records the choices; the Coffee is constructed exactly once, directly
+	where it is going to live - a variable, caller-provided storage or a container.
+	The requestor's name is borrowed as a std::string_view, or taken over if it is an rvalue,
+	and only turned into the Coffee's own string at that point.
+
+		Coffee coffee = CoffeeOrder("Zachary").makeHot().addMilk().costs(4.00).build();
+		CoffeeOrder(name).makeHot().costs(3.50).emplaceInto(orders);
+
+	A borrowed name must outlive the order. Finishing an order uses it up, so build(),
+	buildAt() and emplaceInto() need an rvalue: a chain as above, or std::move(order).
+	*/
+	class CoffeeOrder {
+		std::string_view requestorName;
+		std::string ownedName; // holds the name when it was handed over as an rvalue
+		bool nameOwned = false;
+		bool isHot = false;
+		bool hasMilk = false;
+		bool hasSugar = false;
+		double cost = 0;
+
+		std::string takeName() { return nameOwned ? std::move(ownedName) : std::string(requestorName); }
+
+		public:
+			explicit CoffeeOrder(std::string_view requestorName) : requestorName(requestorName) {}
+			explicit CoffeeOrder(const char* requestorName) : requestorName(requestorName) {}
+			explicit CoffeeOrder(std::string&& requestorName) : ownedName(std::move(requestorName)), nameOwned(true) {}
+
+			// An order is finished once, where it was made; there is nothing to copy it for.
+			// It can still be moved, e.g. returned from a function that fills it in.
+			CoffeeOrder(const CoffeeOrder&) = delete;
+			CoffeeOrder& operator=(const CoffeeOrder&) = delete;
+			CoffeeOrder(CoffeeOrder&&) = default;
+			CoffeeOrder& operator=(CoffeeOrder&&) = default;
+
+			CoffeeOrder& makeHot() & { isHot = true; return *this; }
+			CoffeeOrder& addMilk() & { hasMilk = true; return *this; }
+			CoffeeOrder& addSugar() & { hasSugar = true; return *this; }
+			CoffeeOrder& costs(double price) & { cost = price; return *this; }
+
+			CoffeeOrder&& makeHot() && { return std::move(makeHot()); }
+			CoffeeOrder&& addMilk() && { return std::move(addMilk()); }
+			CoffeeOrder&& addSugar() && { return std::move(addSugar()); }
+			CoffeeOrder&& costs(double price) && { return std::move(costs(price)); }
+
+			// Returned as a prvalue, so "Coffee coffee = ...build();" constructs straight into "coffee".
+			Coffee build() && {
+				RECORD_CREATION("CoffeeOrder::build", "Coffee");
+				return Coffee(takeName(), isHot, hasMilk, hasSugar, cost);
+			}
+
+			// Constructs the coffee in "storage", which must be suitably sized and aligned for a Coffee.
+			Coffee* buildAt(void* storage) && {
+				RECORD_CREATION("CoffeeOrder::buildAt", "Coffee");
+				return new (storage) Coffee(takeName(), isHot, hasMilk, hasSugar, cost);
+			}
+
+			// Appends the coffee to any container with emplace_back, such as std::vector<Coffee>.
+			template <typename Container>
+			Coffee& emplaceInto(Container& container) && {
+				RECORD_CREATION("CoffeeOrder::emplaceInto", "Coffee");
+				return container.emplace_back(takeName(), isHot, hasMilk, hasSugar, cost);
+			}
+	};
+}
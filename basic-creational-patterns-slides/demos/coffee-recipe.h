@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "../../instrumentation/creation-stats.h"
+#include "builder.h"
+
+namespace builderDemo {
+
+	/*
+	Recipes: everything about a Coffee except who asked for it, checked and fixed at compile time.
+
+	CoffeeRecipeBuilder is a typestate builder: every step returns a builder of a different type,
+	which records the steps taken so far. Finishing a recipe without costs(), or taking a step
+	twice, is a compile error rather than a Coffee with a made-up price.
+
+		constexpr CoffeeRecipe flatWhite = CoffeeRecipeBuilder<>().makeHot().addMilk().costs(3.40).recipe();
+		Coffee coffee = flatWhite.pour("Olaf");
+
+	The whole chain runs in the compiler: a constexpr recipe is just four constants in the binary,
+	and pour() is a single Coffee constructor call with them - the same code as writing the flags
+	and cost out by hand. The Coffee itself can't be a constant, since its std::string name can't be
+	created at compile time in C++17.
+	*/
+
+	struct CoffeeRecipe {
+		bool isHot;
+		bool hasMilk;
+		bool hasSugar;
+		double cost;
+
+		// The name goes straight through to Coffee's constructor, so no extra string is made or moved on the way.
+		template <typename Name>
+		Coffee pour(Name&& requestorName) const {
+			RECORD_CREATION("CoffeeRecipe::pour", "Coffee");
+			return Coffee(std::forward<Name>(requestorName), isHot, hasMilk, hasSugar, cost);
+		}
+	};
+
+	namespace CoffeeRecipeSteps {
+		constexpr std::uint8_t hot = 1;
+		constexpr std::uint8_t milk = 2;
+		constexpr std::uint8_t sugar = 4;
+		constexpr std::uint8_t cost = 8;
+	}
+
+	template <std::uint8_t Steps = 0>
+	class CoffeeRecipeBuilder {
+		template <std::uint8_t> friend class CoffeeRecipeBuilder;
+
+		CoffeeRecipe recipeSoFar;
+
+		constexpr explicit CoffeeRecipeBuilder(CoffeeRecipe recipeSoFar) : recipeSoFar(recipeSoFar) {}
+
+		public:
+			constexpr CoffeeRecipeBuilder() : recipeSoFar{ false, false, false, 0 } {}
+
+			constexpr CoffeeRecipeBuilder<Steps | CoffeeRecipeSteps::hot> makeHot() const {
+				static_assert(!(Steps & CoffeeRecipeSteps::hot), "makeHot() is already part of this recipe");
+				CoffeeRecipe next = recipeSoFar;
+				next.isHot = true;
+				return CoffeeRecipeBuilder<Steps | CoffeeRecipeSteps::hot>(next);
+			}
+
+			constexpr CoffeeRecipeBuilder<Steps | CoffeeRecipeSteps::milk> addMilk() const {
+				static_assert(!(Steps & CoffeeRecipeSteps::milk), "addMilk() is already part of this recipe");
+				CoffeeRecipe next = recipeSoFar;
+				next.hasMilk = true;
+				return CoffeeRecipeBuilder<Steps | CoffeeRecipeSteps::milk>(next);
+			}
+
+			constexpr CoffeeRecipeBuilder<Steps | CoffeeRecipeSteps::sugar> addSugar() const {
+				static_assert(!(Steps & CoffeeRecipeSteps::sugar), "addSugar() is already part of this recipe");
+				CoffeeRecipe next = recipeSoFar;
+				next.hasSugar = true;
+				return CoffeeRecipeBuilder<Steps | CoffeeRecipeSteps::sugar>(next);
+			}
+
+			constexpr CoffeeRecipeBuilder<Steps | CoffeeRecipeSteps::cost> costs(double cost) const {
+				static_assert(!(Steps & CoffeeRecipeSteps::cost), "costs() is already part of this recipe");
+				CoffeeRecipe next = recipeSoFar;
+				next.cost = cost;
+				return CoffeeRecipeBuilder<Steps | CoffeeRecipeSteps::cost>(next);
+			}
+
+			// Only a priced recipe can be finished.
+			constexpr CoffeeRecipe recipe() const {
+				static_assert(Steps & CoffeeRecipeSteps::cost, "a recipe needs a price: call costs() before finishing it");
+				return recipeSoFar;
+			}
+
+			// For a one-off coffee: the same checks, without naming the recipe.
+			template <typename Name>
+			Coffee build(Name&& requestorName) const {
+				return recipe().pour(std::forward<Name>(requestorName));
+			}
+	};
+
+	// The house presets. Each one is a compile-time constant.
+	namespace CoffeeRecipes {
+		inline constexpr CoffeeRecipe black = CoffeeRecipeBuilder<>().makeHot().costs(2.50).recipe();
+		inline constexpr CoffeeRecipe sweetWhite = CoffeeRecipeBuilder<>().addSugar().addMilk().costs(3.00).recipe();
+		inline constexpr CoffeeRecipe cappuccino = CoffeeRecipeBuilder<>().makeHot().addMilk().costs(3.50).recipe();
+		inline constexpr CoffeeRecipe latte = CoffeeRecipeBuilder<>().makeHot().addMilk().costs(3.80).recipe();
+		inline constexpr CoffeeRecipe sweetCappuccino = CoffeeRecipeBuilder<>().makeHot().addMilk().addSugar().costs(3.70).recipe();
+		inline constexpr CoffeeRecipe icedLatte = CoffeeRecipeBuilder<>().addMilk().costs(4.00).recipe();
+	}
+}
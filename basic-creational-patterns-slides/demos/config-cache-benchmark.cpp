@@ -0,0 +1,120 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "config-cache.h"
+#include "../../bench/alloc-counter.h"
+#include "../../bench/bench-util.h"
+
+using namespace singletonDemo;
+
+/*
+Per-read cost of the hot config keys at 1 to 64 threads: the singleton's own accessors
+against a per-thread CachedCoffeeConfig.
+
+Build:
+	g++ -std=c++17 -O2 -pthread config-cache-benchmark.cpp -o config-cache-benchmark
+
+Every reader thread alternates between COFFEE_STATUS and COFFEE_HEALTH_URL, the way a
+request handler checks them, while a writer publishes a new status every millisecond.
+ns/op is wall time divided by the reads of all threads together; with more threads than
+cores it is what a read costs the whole machine.
+*/
+
+namespace {
+	const int readsPerThread = 1000000;
+
+	// Long enough that a copy can't fit in the small-string buffer.
+	const char *const statusValues[] = { "ON - brewing at full capacity", "ON - descaling, brewing slowly" };
+
+	template <typename ReadOne>
+	void run(const char *name, int readers, ReadOne readOne) {
+		GlobalCoffeeConfig &config = GlobalCoffeeConfig::get();
+		std::atomic<bool> done{ false };
+		std::atomic<int> writes{ 0 };
+
+		std::thread writer([&] {
+			for (int round = 0; !done.load(std::memory_order_relaxed); round++) {
+				config.setState(std::string(CoffeeKeys::status.name), statusValues[round % 2]);
+				writes.fetch_add(1, std::memory_order_relaxed);
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		});
+
+		bench::Clock::time_point start = bench::Clock::now();
+		std::vector<std::thread> threads;
+		for (int t = 0; t < readers; t++) {
+			threads.emplace_back([&] {
+				std::size_t sum = 0;
+				for (int i = 0; i < readsPerThread; i++) {
+					sum += readOne(i % 2 ? CoffeeKeys::healthUrl : CoffeeKeys::status);
+				}
+				bench::doNotOptimize(sum);
+			});
+		}
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+		double seconds = bench::secondsSince(start);
+		done = true;
+		writer.join();
+
+		char label[96];
+		std::snprintf(label, sizeof(label), "%s, %d threads (%d writes)", name, readers, writes.load());
+		bench::report(label, double(readsPerThread) * readers, seconds);
+	}
+
+	bool check(bool ok, const char *what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+		}
+		return ok;
+	}
+}
+
+int main() {
+	GlobalCoffeeConfig &config = GlobalCoffeeConfig::get();
+	config.publish(ConfigBatch()
+		.setState(std::string(CoffeeKeys::status.name), statusValues[0])
+		.setState(std::string(CoffeeKeys::healthUrl.name), "https://coffee.local/health"));
+
+	// A cache must pick up a publish on its next read, on this thread and on any other.
+	bool ok = check(CachedCoffeeConfig::local().view(CoffeeKeys::status) == statusValues[0], "first cached read");
+	config.setState(std::string(CoffeeKeys::status.name), statusValues[1]);
+	ok &= check(CachedCoffeeConfig::local().view(CoffeeKeys::status) == statusValues[1], "cached read after a publish");
+	std::thread([&] {
+		ok &= check(CachedCoffeeConfig::local().view(CoffeeKeys::healthUrl) == "https://coffee.local/health", "cached read on a new thread");
+	}).join();
+
+	// Between publishes, a cached read touches nothing but this thread's cache and the version.
+	bench::AllocationStats before = bench::AllocationStats::now();
+	std::size_t sum = 0;
+	for (int i = 0; i < readsPerThread; i++) {
+		sum += CachedCoffeeConfig::local().view(CoffeeKeys::status).size();
+	}
+	bench::doNotOptimize(sum);
+	ok &= check((bench::AllocationStats::now() - before).count == 0, "steady-state cached reads allocated");
+	if (!ok) {
+		return EXIT_FAILURE;
+	}
+
+	for (int readers = 1; readers <= 64; readers *= 2) {
+		run("get().getState()", readers, [](const ConfigKey &key) {
+			return GlobalCoffeeConfig::get().getState(key).size();
+		});
+		run("Reader(get()).view()", readers, [](const ConfigKey &key) {
+			GlobalCoffeeConfig::Reader reader(GlobalCoffeeConfig::get());
+			return reader.view(key).size();
+		});
+		run("CachedCoffeeConfig::local().view()", readers, [](const ConfigKey &key) {
+			return CachedCoffeeConfig::local().view(key).size();
+		});
+		std::printf("\n");
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "config-key.h"
+#include "singleton.h"
+
+namespace singletonDemo {
+
+	/*
+	A per-thread copy of the few keys a worker reads on every request.
+
+	Even a Reader costs something per read: GlobalCoffeeConfig::get() checks its static guard,
+	and pinning a snapshot stores to the thread's hazard slot with a full fence. A
+	CachedCoffeeConfig instead keeps its own copy of the hot values and, on each read, only
+	loads the published version - one cache line that is written once per publish, so it
+	stays shared in every core's cache between writes. The values are copied again only when
+	that version has moved on.
+
+		std::string_view status = CachedCoffeeConfig::local().view(CoffeeKeys::status);
+
+	Each cache belongs to one thread and sits on cache lines of its own; never share one
+	between threads. Views stay valid until the next view() on the same cache.
+	*/
+	class alignas(64) CachedCoffeeConfig {
+		public:
+			static constexpr std::size_t maxKeys = 8;
+
+		private:
+			struct Entry {
+				std::uint64_t hash = 0;
+				std::string_view name;
+				std::string value;
+			};
+
+			GlobalCoffeeConfig *config;
+			// Version the copies were taken from. The first view() always refreshes.
+			std::uint64_t seenVersion = ~std::uint64_t(0);
+			std::size_t keyCount = 0;
+			Entry entries[maxKeys];
+
+			void refresh() {
+				GlobalCoffeeConfig::Reader reader(*config);
+				for (std::size_t i = 0; i < keyCount; i++) {
+					// assign() reuses the string's buffer, so a refresh only allocates when a value grows.
+					entries[i].value.assign(reader.view(entries[i].name, entries[i].hash));
+				}
+				seenVersion = reader.version();
+			}
+
+		public:
+			// Throws std::invalid_argument for more than maxKeys keys.
+			explicit CachedCoffeeConfig(std::initializer_list<ConfigKey> keys, GlobalCoffeeConfig &config = GlobalCoffeeConfig::get())
+				: config(&config) {
+				if (keys.size() > maxKeys) {
+					throw std::invalid_argument("CachedCoffeeConfig: at most " + std::to_string(maxKeys) + " keys can be cached");
+				}
+				for (const ConfigKey &key : keys) {
+					entries[keyCount].hash = key.hash;
+					entries[keyCount].name = key.name;
+					keyCount++;
+				}
+			}
+
+			CachedCoffeeConfig(const CachedCoffeeConfig &) = delete;
+			CachedCoffeeConfig &operator=(const CachedCoffeeConfig &) = delete;
+
+			// Missing keys come back as an empty view, like Reader::view().
+			// Throws std::out_of_range for a key this cache wasn't built with.
+			std::string_view view(const ConfigKey &key) {
+				if (config->changedSince(seenVersion)) {
+					refresh();
+				}
+				for (std::size_t i = 0; i < keyCount; i++) {
+					if (entries[i].hash == key.hash && entries[i].name == key.name) {
+						return entries[i].value;
+					}
+				}
+				throw std::out_of_range("CachedCoffeeConfig: " + std::string(key.name) + " is not a cached key");
+			}
+
+			// The version of the values handed out by the last view().
+			std::uint64_t version() const { return seenVersion; }
+
+			// This thread's cache of the keys our own services read on every request.
+			static CachedCoffeeConfig &local() {
+				thread_local CachedCoffeeConfig cache{ CoffeeKeys::status, CoffeeKeys::healthUrl };
+				return cache;
+			}
+	};
+}
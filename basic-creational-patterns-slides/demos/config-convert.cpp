@@ -0,0 +1,27 @@
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include "config-file.h"
+
+using namespace singletonDemo;
+
+/*
+Converts a plain key=value text config into the binary format that
+GlobalCoffeeConfig::loadFile() maps into memory.
+
+	config-convert coffee.conf coffee.ccfg
+*/
+int main(int argc, char **argv) {
+	if (argc != 3) {
+		std::fprintf(stderr, "usage: %s <input key=value file> <output binary file>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	try {
+		convertTextConfig(argv[1], argv[2]);
+	} catch (const std::exception &error) {
+		std::fprintf(stderr, "%s\n", error.what());
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "singleton.h"
+#include "config-file.h"
+#include "../../bench/alloc-counter.h"
+#include "../../bench/bench-util.h"
+
+using namespace singletonDemo;
+
+/*
+Startup-time benchmark for GlobalCoffeeConfig.
+
+Loads a config with a few hundred thousand keys two ways:
+ - the text way: parse key=value lines into a map and build a snapshot from it,
+   which is what publishing everything in one batch costs;
+ - the mapped way: convert the text once, offline, then loadFile() the binary file.
+For each we report wall time and heap usage, then the cost of a lookup afterwards.
+*/
+static void printAllocations(const char *name, const bench::AllocationStats &allocations) {
+	std::printf("%-48s %12zu allocations %10.1f MB\n", name, allocations.count, allocations.bytes / 1e6);
+}
+
+int main(int argc, char **argv) {
+	int keyCount = argc > 1 ? std::atoi(argv[1]) : 300000;
+	std::filesystem::path directory = std::filesystem::temp_directory_path();
+	std::string textPath = (directory / "coffee-benchmark.conf").string();
+	std::string binaryPath = (directory / "coffee-benchmark.ccfg").string();
+
+	{
+		std::ofstream text(textPath);
+		for (int i = 0; i < keyCount; i++) {
+			text << "COFFEE_SETTING_" << i << "=value-of-setting-number-" << i << "\n";
+		}
+	}
+
+	// Text path.
+	bench::AllocationStats before = bench::AllocationStats::now();
+	auto start = bench::Clock::now();
+	std::map<std::string, std::string> state = readTextConfig(textPath);
+	ConfigSnapshot snapshot(state, 1);
+	double textSeconds = bench::secondsSince(start);
+	bench::AllocationStats textAllocations = bench::AllocationStats::now() - before;
+	bench::report("startup: parse text + build snapshot", 1, textSeconds);
+	printAllocations("", textAllocations);
+
+	// The one-off conversion, for reference. This runs offline, not at startup.
+	start = bench::Clock::now();
+	writeConfigFile(state, binaryPath);
+	bench::report("offline: convert to binary", 1, bench::secondsSince(start));
+
+	// Mapped path.
+	GlobalCoffeeConfig &config = GlobalCoffeeConfig::get();
+	{
+		GlobalCoffeeConfig::Reader warmUp(config); // claims this thread's reader slot up front
+	}
+	before = bench::AllocationStats::now();
+	start = bench::Clock::now();
+	config.loadFile(binaryPath);
+	double mappedSeconds = bench::secondsSince(start);
+	bench::AllocationStats mappedAllocations = bench::AllocationStats::now() - before;
+	bench::report("startup: loadFile (mmap)", 1, mappedSeconds);
+	printAllocations("", mappedAllocations);
+
+	// Lookups afterwards: the text-built snapshot against views into the mapping.
+	const int lookups = 5000000;
+	std::vector<std::string> keys;
+	for (int i = 0; i < 1024; i++) {
+		keys.push_back("COFFEE_SETTING_" + std::to_string((i * 7919) % keyCount));
+	}
+
+	std::size_t sum = 0;
+	start = bench::Clock::now();
+	for (int i = 0; i < lookups; i++) {
+		std::string_view value;
+		const std::string &key = keys[i & 1023];
+		snapshot.view(key, hashConfigKey(key), value);
+		sum += value.size();
+	}
+	bench::report("lookup: in-memory snapshot", lookups, bench::secondsSince(start));
+
+	start = bench::Clock::now();
+	for (int i = 0; i < lookups; i++) {
+		GlobalCoffeeConfig::Reader reader(config);
+		sum += reader.view(keys[i & 1023]).size();
+	}
+	bench::report("lookup: mapped file", lookups, bench::secondsSince(start));
+	bench::doNotOptimize(sum);
+
+	if (config.getState("COFFEE_SETTING_0") != "value-of-setting-number-0") {
+		std::printf("FAILED: mapped lookup returned the wrong value\n");
+		return EXIT_FAILURE;
+	}
+
+	std::filesystem::remove(textPath);
+	std::filesystem::remove(binaryPath);
+	return EXIT_SUCCESS;
+}
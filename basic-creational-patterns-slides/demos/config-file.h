@@ -0,0 +1,329 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "config-key.h"
+
+namespace singletonDemo {
+
+	/*
+	The binary config file format.
+
+	A config with hundreds of thousands of keys is too slow to load one setState() at a time,
+	so it is converted once, offline, into a file that can be mapped straight into memory:
+
+		FileHeader
+		slots[slotCount]         open-addressing hash index, entry index plus one, 0 means empty
+		entries[entryCount]      hash of the key, and where its key and value bytes are
+		strings                  all keys and values, back to back, not NUL-terminated
+
+	Opening the file only maps it and checks the header, so it costs the same no matter how
+	many keys there are. Lookups hash the key, probe the index and return views into the mapping,
+	so no key or value is ever copied onto the heap.
+	The file is written in the machine's native byte order; it is a cache for this machine,
+	not an interchange format. Convert the text file again when moving it elsewhere.
+	*/
+	namespace ConfigFileFormat {
+		constexpr char magic[4] = { 'C', 'C', 'F', 'G' };
+		constexpr std::uint32_t formatVersion = 1;
+
+		struct FileHeader {
+			char magic[4];
+			std::uint32_t formatVersion;
+			std::uint64_t entryCount;
+			std::uint64_t slotCount;
+			std::uint64_t slotsOffset;
+			std::uint64_t entriesOffset;
+			std::uint64_t stringsOffset;
+			std::uint64_t fileSize;
+		};
+
+		struct FileEntry {
+			std::uint64_t hash;
+			std::uint64_t keyOffset;    // relative to the start of the strings section
+			std::uint64_t valueOffset;  // relative to the start of the strings section
+			std::uint32_t keyLength;
+			std::uint32_t valueLength;
+		};
+
+		inline std::uint64_t alignTo8(std::uint64_t offset) {
+			return (offset + 7) & ~std::uint64_t(7);
+		}
+
+		// Whether [offset, offset + count * elementSize) fits in "size" bytes, without overflowing.
+		inline bool fits(std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize, std::uint64_t size) {
+			return offset <= size && count <= (size - offset) / elementSize;
+		}
+
+		// Whether [offset, offset + length) fits in "size" bytes, without overflowing.
+		inline bool fits(std::uint64_t offset, std::uint64_t length, std::uint64_t size) {
+			return offset <= size && length <= size - offset;
+		}
+	}
+
+	/*
+	Writes "state" in the binary format. Throws std::runtime_error if the file can't be written, and
+	std::length_error, before writing anything, for a key or value of 4 GiB or more or for more
+	entries than a slot's 32-bit index can tell apart.
+	*/
+	inline void writeConfigFile(const std::map<std::string, std::string> &state, const std::string &path) {
+		using namespace ConfigFileFormat;
+
+		const std::uint64_t maxLength = std::numeric_limits<std::uint32_t>::max();
+		// Slots hold an entry's index plus one, and 0 marks an empty slot.
+		if (state.size() > maxLength) {
+			throw std::length_error("writeConfigFile: too many entries for " + path);
+		}
+		for (const auto &keyValue : state) {
+			if (keyValue.first.size() > maxLength || keyValue.second.size() > maxLength) {
+				throw std::length_error("writeConfigFile: key or value too long for " + path);
+			}
+		}
+
+		std::uint64_t slotCount = 8;
+		while (slotCount < state.size() * 2) {
+			slotCount *= 2;
+		}
+
+		FileHeader header = {};
+		std::memcpy(header.magic, magic, sizeof(magic));
+		header.formatVersion = formatVersion;
+		header.entryCount = state.size();
+		header.slotCount = slotCount;
+		header.slotsOffset = alignTo8(sizeof(FileHeader));
+		header.entriesOffset = alignTo8(header.slotsOffset + slotCount * sizeof(std::uint32_t));
+		header.stringsOffset = header.entriesOffset + state.size() * sizeof(FileEntry);
+
+		std::vector<std::uint32_t> slots(slotCount, 0);
+		std::vector<FileEntry> entries;
+		entries.reserve(state.size());
+		std::string strings;
+
+		for (const auto &keyValue : state) {
+			FileEntry entry = {};
+			entry.hash = hashConfigKey(keyValue.first);
+			entry.keyOffset = strings.size();
+			entry.keyLength = static_cast<std::uint32_t>(keyValue.first.size());
+			strings += keyValue.first;
+			entry.valueOffset = strings.size();
+			entry.valueLength = static_cast<std::uint32_t>(keyValue.second.size());
+			strings += keyValue.second;
+			entries.push_back(entry);
+
+			std::uint64_t slot = entry.hash & (slotCount - 1);
+			while (slots[slot] != 0) {
+				slot = (slot + 1) & (slotCount - 1);
+			}
+			slots[slot] = static_cast<std::uint32_t>(entries.size());
+		}
+		header.fileSize = header.stringsOffset + strings.size();
+
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			throw std::runtime_error("writeConfigFile: can't open " + path);
+		}
+
+		auto padTo = [&out](std::uint64_t offset) {
+			static const char zeros[8] = {};
+			std::uint64_t position = static_cast<std::uint64_t>(out.tellp());
+			out.write(zeros, static_cast<std::streamsize>(offset - position));
+		};
+
+		out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		padTo(header.slotsOffset);
+		out.write(reinterpret_cast<const char *>(slots.data()), static_cast<std::streamsize>(slots.size() * sizeof(std::uint32_t)));
+		padTo(header.entriesOffset);
+		out.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(FileEntry)));
+		out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+		if (!out) {
+			throw std::runtime_error("writeConfigFile: failed writing " + path);
+		}
+	}
+
+	/*
+	Reads a plain text config: one key=value per line.
+	Blank lines and lines starting with '#' are skipped, and a later line for the same key wins.
+	Throws std::runtime_error for a missing file or a line without '='.
+	*/
+	inline std::map<std::string, std::string> readTextConfig(const std::string &path) {
+		std::ifstream in(path);
+		if (!in) {
+			throw std::runtime_error("readTextConfig: can't open " + path);
+		}
+
+		std::map<std::string, std::string> state;
+		std::string line;
+		for (int lineNumber = 1; std::getline(in, line); lineNumber++) {
+			if (!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+			if (line.empty() || line[0] == '#') {
+				continue;
+			}
+
+			std::size_t equals = line.find('=');
+			if (equals == std::string::npos) {
+				throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": expected key=value");
+			}
+			state.insert_or_assign(line.substr(0, equals), line.substr(equals + 1));
+		}
+		return state;
+	}
+
+	// The converter: a plain key=value text file in, a mappable binary file out.
+	inline void convertTextConfig(const std::string &textPath, const std::string &binaryPath) {
+		writeConfigFile(readTextConfig(textPath), binaryPath);
+	}
+
+	/*
+	A binary config file mapped read-only into memory.
+	Everything it hands out is a view into the mapping, valid for as long as the file object lives.
+	Opening throws std::runtime_error if the file is missing or isn't a valid config file.
+	*/
+	class MappedConfigFile {
+		const char *data = nullptr;
+		std::size_t size = 0;
+		const ConfigFileFormat::FileHeader *header = nullptr;
+		const std::uint32_t *slots = nullptr;
+		const ConfigFileFormat::FileEntry *entries = nullptr;
+		const char *strings = nullptr;
+
+#if defined(_WIN32)
+		// No mmap here: read the file into one buffer instead. Still a single allocation.
+		std::vector<char> buffer;
+#endif
+
+		void fail(const std::string &path, const char *reason) {
+			unmap();
+			throw std::runtime_error("MappedConfigFile: " + path + ": " + reason);
+		}
+
+		void unmap() {
+#if !defined(_WIN32)
+			if (data) {
+				munmap(const_cast<char *>(data), size);
+			}
+#endif
+			data = nullptr;
+			size = 0;
+		}
+
+		public:
+			explicit MappedConfigFile(const std::string &path) {
+#if defined(_WIN32)
+				std::ifstream in(path, std::ios::binary);
+				if (!in) {
+					fail(path, "can't open");
+				}
+				buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+				data = buffer.data();
+				size = buffer.size();
+#else
+				int fd = open(path.c_str(), O_RDONLY);
+				if (fd < 0) {
+					fail(path, "can't open");
+				}
+				struct stat info;
+				if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(ConfigFileFormat::FileHeader))) {
+					close(fd);
+					fail(path, "too small to be a config file");
+				}
+				size = static_cast<std::size_t>(info.st_size);
+				void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+				close(fd);
+				if (mapping == MAP_FAILED) {
+					size = 0;
+					fail(path, "mmap failed");
+				}
+				data = static_cast<const char *>(mapping);
+#endif
+
+				using namespace ConfigFileFormat;
+				if (size < sizeof(FileHeader)) {
+					fail(path, "too small to be a config file");
+				}
+				header = reinterpret_cast<const FileHeader *>(data);
+				if (std::memcmp(header->magic, magic, sizeof(magic)) != 0 || header->formatVersion != formatVersion) {
+					fail(path, "not a config file, or written by a different version");
+				}
+				/*
+				Everything find() relies on without checking again: a power-of-two index with at
+				least one empty slot, so every probe ends; and sections that are aligned for their
+				element type, in order, and inside the file, with sizes that can't overflow.
+				*/
+				if (header->fileSize != size ||
+					header->slotCount == 0 || (header->slotCount & (header->slotCount - 1)) != 0 ||
+					header->slotCount <= header->entryCount ||
+					header->slotsOffset < sizeof(FileHeader) ||
+					header->slotsOffset % alignof(std::uint32_t) != 0 ||
+					header->entriesOffset % alignof(FileEntry) != 0 ||
+					!fits(header->slotsOffset, header->slotCount, sizeof(std::uint32_t), header->entriesOffset) ||
+					!fits(header->entriesOffset, header->entryCount, sizeof(FileEntry), header->stringsOffset) ||
+					header->stringsOffset > size) {
+					fail(path, "corrupt header");
+				}
+
+				slots = reinterpret_cast<const std::uint32_t *>(data + header->slotsOffset);
+				entries = reinterpret_cast<const FileEntry *>(data + header->entriesOffset);
+				strings = data + header->stringsOffset;
+			}
+
+			~MappedConfigFile() { unmap(); }
+
+			MappedConfigFile(const MappedConfigFile &) = delete;
+			MappedConfigFile &operator=(const MappedConfigFile &) = delete;
+
+			// Returns false when the key is not present. On success "value" views into the mapping.
+			bool find(std::string_view key, std::uint64_t hash, std::string_view &value) const {
+				using ConfigFileFormat::fits;
+				std::size_t mask = header->slotCount - 1;
+				std::size_t stringsSize = size - header->stringsOffset;
+
+				// The header promises more slots than entries, but a corrupt index could still fill
+				// every slot: never probe more than each slot once.
+				std::size_t slot = hash & mask;
+				for (std::size_t probes = 0; probes < header->slotCount && slots[slot] != 0; probes++, slot = (slot + 1) & mask) {
+					std::uint32_t index = slots[slot] - 1;
+					if (index >= header->entryCount) {
+						return false; // corrupt index - treat as missing rather than read out of bounds
+					}
+					const ConfigFileFormat::FileEntry &entry = entries[index];
+					if (entry.hash != hash || entry.keyLength != key.size()) {
+						continue;
+					}
+					if (!fits(entry.keyOffset, entry.keyLength, stringsSize) || !fits(entry.valueOffset, entry.valueLength, stringsSize)) {
+						return false; // corrupt entry - its strings would lie outside the file
+					}
+					if (std::string_view(strings + entry.keyOffset, entry.keyLength) == key) {
+						value = std::string_view(strings + entry.valueOffset, entry.valueLength);
+						return true;
+					}
+				}
+				return false;
+			}
+
+			bool find(std::string_view key, std::string_view &value) const { return find(key, hashConfigKey(key), value); }
+			bool find(const ConfigKey &key, std::string_view &value) const { return find(key.name, key.hash, value); }
+
+			std::size_t keyCount() const { return static_cast<std::size_t>(header->entryCount); }
+	};
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+namespace singletonDemo {
+
+	// FNV-1a. Cheap, and good enough to spread config keys over a hash table.
+	// constexpr so that keys spelled as literals can be hashed at compile time.
+	constexpr std::uint64_t hashConfigKey(std::string_view key) {
+		std::uint64_t hash = 14695981039346656037ull;
+		for (char c : key) {
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	/*
+	A pre-interned key: the name together with its hash, computed once.
+	Declare hot keys as constexpr constants and look them up through these handles -
+	the lookup then skips hashing and never has to build a std::string.
+	*/
+	struct ConfigKey {
+		std::string_view name;
+		std::uint64_t hash;
+
+		constexpr explicit ConfigKey(std::string_view name) : name(name), hash(hashConfigKey(name)) {}
+	};
+
+	// The keys our own services read on every request.
+	namespace CoffeeKeys {
+		constexpr ConfigKey status{ "COFFEE_STATUS" };
+		constexpr ConfigKey healthUrl{ "COFFEE_HEALTH_URL" };
+	}
+}
@@ -0,0 +1,228 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace singletonDemo {
+
+	/*
+	One key's new value, as of the version that changed it.
+	Or, with "reloaded" set and no key, the news that a config file was loaded at that version:
+	subscribers to every key get this instead of a copy of the whole file, and re-read
+	whatever they need.
+	*/
+	struct ConfigChange {
+		std::string key;
+		std::string value;
+		std::uint64_t version;
+		bool reloaded = false;
+	};
+
+	/*
+	Delivers config changes to subscribers on a background thread.
+
+	Writers only append their changes to a queue and wake the delivery thread, so a slow
+	callback never holds up a publish. The delivery thread drains everything queued since
+	it last ran, keeps only the newest value per key, and hands each subscriber all of its
+	changes in one call. A subscriber can therefore skip intermediate values, but always
+	sees the latest one.
+	*/
+	class ConfigWatchers {
+		public:
+			using Callback = std::function<void(const std::vector<ConfigChange> &)>;
+			using SubscriptionId = std::uint64_t;
+
+			// Looks up a key's current value; used when a whole config file was swapped in.
+			using CurrentValue = std::function<std::string(const std::string &)>;
+
+		private:
+			struct Subscription {
+				SubscriptionId id;
+				std::vector<std::string> keys; // empty means every key
+				Callback callback;
+
+				bool wants(const std::string &key) const {
+					return keys.empty() || std::find(keys.begin(), keys.end(), key) != keys.end();
+				}
+			};
+
+			struct Pending {
+				std::vector<std::pair<std::string, std::string>> changes;
+				std::uint64_t version;
+				bool everything; // a config file was loaded - any key may have changed
+			};
+
+			CurrentValue currentValue;
+
+			std::mutex queueMutex;
+			std::condition_variable queueChanged;
+			std::condition_variable deliveredChanged;
+			std::vector<Pending> queue;
+			std::uint64_t queuedVersion = 0;
+			std::uint64_t deliveredVersion = 0;
+			bool stopping = false;
+
+			// Held for the whole of a delivery, so unsubscribe() can wait for one in progress.
+			std::mutex deliveryMutex;
+			std::mutex subscriptionsMutex;
+			std::vector<std::shared_ptr<const Subscription>> subscriptions;
+			SubscriptionId nextId = 1;
+
+			std::thread deliveryThread;
+
+			void deliverLoop() {
+				for (;;) {
+					std::vector<Pending> batch;
+					{
+						std::unique_lock<std::mutex> lock(queueMutex);
+						queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+						if (queue.empty()) {
+							return;
+						}
+						batch.swap(queue);
+					}
+
+					std::lock_guard<std::mutex> delivering(deliveryMutex);
+					deliver(batch);
+
+					std::lock_guard<std::mutex> lock(queueMutex);
+					deliveredVersion = batch.back().version;
+					deliveredChanged.notify_all();
+				}
+			}
+
+			void deliver(const std::vector<Pending> &batch) {
+				std::vector<std::shared_ptr<const Subscription>> current;
+				{
+					std::lock_guard<std::mutex> lock(subscriptionsMutex);
+					current = subscriptions;
+				}
+				if (current.empty()) {
+					return;
+				}
+
+				// Newest value per key wins.
+				std::map<std::string, ConfigChange> latest;
+				bool everything = false;
+				for (const Pending &pending : batch) {
+					everything |= pending.everything;
+					for (const auto &change : pending.changes) {
+						latest[change.first] = { change.first, change.second, pending.version };
+					}
+				}
+
+				// After a file load we can't tell which keys changed, so re-send every watched key,
+				// and tell those watching every key that everything may have changed.
+				std::uint64_t reloadVersion = 0;
+				if (everything) {
+					reloadVersion = batch.back().version;
+					for (const auto &subscription : current) {
+						for (const std::string &key : subscription->keys) {
+							latest[key] = { key, currentValue(key), reloadVersion };
+						}
+					}
+				}
+
+				for (const auto &subscription : current) {
+					std::vector<ConfigChange> changes;
+					if (everything && subscription->keys.empty()) {
+						changes.push_back({ std::string(), std::string(), reloadVersion, true });
+					}
+					for (const auto &keyChange : latest) {
+						if (subscription->wants(keyChange.first)) {
+							changes.push_back(keyChange.second);
+						}
+					}
+					if (!changes.empty()) {
+						subscription->callback(changes);
+					}
+				}
+			}
+
+		public:
+			explicit ConfigWatchers(CurrentValue currentValue) : currentValue(std::move(currentValue)) {}
+
+			~ConfigWatchers() { stop(); }
+
+			// Delivers whatever is still queued, then shuts the delivery thread down.
+			void stop() {
+				{
+					std::lock_guard<std::mutex> lock(queueMutex);
+					stopping = true;
+				}
+				queueChanged.notify_all();
+				deliveredChanged.notify_all();
+				if (deliveryThread.joinable()) {
+					deliveryThread.join();
+				}
+			}
+
+			ConfigWatchers(const ConfigWatchers &) = delete;
+			ConfigWatchers &operator=(const ConfigWatchers &) = delete;
+
+			// Watches "keys" - or every key, if "keys" is empty. The delivery thread starts on first use.
+			SubscriptionId subscribe(std::vector<std::string> keys, Callback callback) {
+				std::lock_guard<std::mutex> lock(subscriptionsMutex);
+				SubscriptionId id = nextId++;
+				subscriptions.push_back(std::make_shared<const Subscription>(Subscription{ id, std::move(keys), std::move(callback) }));
+
+				std::lock_guard<std::mutex> queueLock(queueMutex);
+				if (!deliveryThread.joinable() && !stopping) {
+					deliveryThread = std::thread(&ConfigWatchers::deliverLoop, this);
+				}
+				return id;
+			}
+
+			/*
+			Once this returns, the callback will not be called again.
+			If a delivery is in progress on another thread, this waits for it to finish;
+			calling it from inside a callback is fine too.
+			*/
+			void unsubscribe(SubscriptionId id) {
+				{
+					std::lock_guard<std::mutex> lock(subscriptionsMutex);
+					subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+						[id](const std::shared_ptr<const Subscription> &subscription) { return subscription->id == id; }),
+						subscriptions.end());
+				}
+				std::thread::id deliveryThreadId;
+				{
+					std::lock_guard<std::mutex> lock(queueMutex);
+					deliveryThreadId = deliveryThread.get_id();
+				}
+				if (std::this_thread::get_id() != deliveryThreadId) {
+					std::lock_guard<std::mutex> delivering(deliveryMutex);
+				}
+			}
+
+			// Called by writers. Only queues the changes; delivery happens on the background thread.
+			void enqueue(std::vector<std::pair<std::string, std::string>> changes, std::uint64_t version, bool everything) {
+				{
+					std::lock_guard<std::mutex> lock(queueMutex);
+					if (!deliveryThread.joinable() || stopping) {
+						deliveredVersion = version; // nobody is listening yet
+						queuedVersion = version;
+						return;
+					}
+					queue.push_back({ std::move(changes), version, everything });
+					queuedVersion = version;
+				}
+				queueChanged.notify_one();
+			}
+
+			// Blocks until every change queued so far has been delivered.
+			void flush() {
+				std::unique_lock<std::mutex> lock(queueMutex);
+				std::uint64_t target = queuedVersion;
+				deliveredChanged.wait(lock, [this, target] { return deliveredVersion >= target || stopping; });
+			}
+	};
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+namespace prototypeDemo {
+
+	/*
+	A value that is shared between copies until one of them writes to it.
+
+	Copying a CopyOnWrite only bumps a reference count, however big the value is.
+	read() gives const access to the shared value. write() first makes a private copy
+	if anyone else still shares it, so other copies never see the change.
+
+	Like any other value type, one CopyOnWrite object must not be written from one
+	thread while another thread copies or reads that same object. Separate copies can
+	be used freely from different threads.
+
+	That last promise is why this keeps its own count instead of asking a shared_ptr for
+	use_count(), which is only a relaxed load. write() may skip the copy because it sees
+	that the last other owner has just let go on another thread; the acquire load of the
+	count, paired with that owner's release decrement, makes sure its reads of the value
+	are finished before this copy starts writing in place.
+	*/
+	template <typename T>
+	class CopyOnWrite {
+		struct Block {
+			std::atomic<long> owners{ 1 };
+			T value;
+
+			Block() = default;
+			explicit Block(T initial) : value(std::move(initial)) {}
+		};
+
+		Block *block;
+
+		// Default-constructed values all share one empty T, so they cost no allocation either.
+		// It is never freed, so it outlives every static object that still shares it.
+		static Block *empty() {
+			static Block *const instance = new Block();
+			instance->owners.fetch_add(1, std::memory_order_relaxed);
+			return instance;
+		}
+
+		void release() {
+			if (block->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				delete block;
+			}
+		}
+
+		public:
+			CopyOnWrite() : block(empty()) {}
+			explicit CopyOnWrite(T initial) : block(new Block(std::move(initial))) {}
+
+			CopyOnWrite(const CopyOnWrite &other) : block(other.block) {
+				block->owners.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			// Leaves "other" holding the same empty value as a default-constructed copy.
+			CopyOnWrite(CopyOnWrite &&other) noexcept : block(std::exchange(other.block, empty())) {}
+
+			CopyOnWrite &operator=(CopyOnWrite other) noexcept {
+				std::swap(block, other.block);
+				return *this;
+			}
+
+			~CopyOnWrite() { release(); }
+
+			const T &read() const { return block->value; }
+
+			T &write() {
+				if (block->owners.load(std::memory_order_acquire) != 1) {
+					Block *copy = new Block(block->value);
+					release();
+					block = copy;
+				}
+				// We are the only owner now, so handing out mutable access is safe.
+				return block->value;
+			}
+
+			// True while this copy still shares its value with another copy.
+			bool shared() const { return block->owners.load(std::memory_order_acquire) > 1; }
+	};
+}
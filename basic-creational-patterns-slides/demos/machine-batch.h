@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace prototypeDemo {
+
+	class CoffeeMachine;
+
+	/*
+	N copies of one prototype, stored back to back in a single block.
+
+	Building a fleet one createMachine() at a time costs a virtual clone(), a heap allocation
+	and a pointer per machine, and leaves the machines scattered around the heap. A batch pays
+	for one virtual call and one allocation, and keeps the machines contiguous.
+	brewAll() makes one virtual call into the batch and then brews every machine with a direct,
+	non-virtual call, walking memory in order.
+	*/
+	class MachineBatch {
+		struct Storage {
+			virtual ~Storage() = default;
+			virtual std::size_t size() const = 0;
+			virtual CoffeeMachine &at(std::size_t index) = 0;
+			virtual void brewAll() = 0;
+		};
+
+		template <typename T>
+		struct TypedStorage : Storage {
+			std::vector<T> machines;
+
+			TypedStorage(const T &prototype, std::size_t count) : machines(count, prototype) {}
+
+			std::size_t size() const override { return machines.size(); }
+			CoffeeMachine &at(std::size_t index) override { return machines[index]; }
+
+			void brewAll() override {
+				for (T &machine : machines) {
+					machine.T::brew(); // qualified, so the compiler calls T::brew directly
+				}
+			}
+		};
+
+		std::unique_ptr<Storage> storage;
+
+		explicit MachineBatch(std::unique_ptr<Storage> storage) : storage(std::move(storage)) {}
+
+		public:
+			MachineBatch() = default;
+
+			// "count" copies of "prototype". Used by each prototype's cloneBatch().
+			template <typename T>
+			static MachineBatch of(const T &prototype, std::size_t count) {
+				return MachineBatch(std::make_unique<TypedStorage<T>>(prototype, count));
+			}
+
+			std::size_t size() const { return storage ? storage->size() : 0; }
+			CoffeeMachine &operator[](std::size_t index) { return storage->at(index); }
+
+			void brewAll() {
+				if (storage) {
+					storage->brewAll();
+				}
+			}
+	};
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace prototypeDemo {
+
+	// One drink a machine knows how to make.
+	struct Recipe {
+		std::string name;
+		double waterMl;
+		double coffeeGrams;
+		int brewSeconds;
+	};
+
+	/*
+	The configuration a real coffee machine is set up with: its recipe table and
+	the calibration readings for its sensors. This is the "lots of data" that makes
+	a machine expensive to build from scratch - and the reason we clone prototypes.
+	*/
+	struct MachineConfig {
+		std::vector<Recipe> recipes;
+		std::vector<float> calibration;
+	};
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "prototype.h"
+#include "../../bench/bench-util.h"
+
+using namespace prototypeDemo;
+
+/*
+Brewing a fleet of 10M mixed machines: a std::vector<CoffeeMachine*>, as in prototype.cpp's
+main(), against a MachineFleet, on one thread and on several.
+
+Build:
+	g++ -std=c++17 -O2 -pthread machine-fleet-benchmark.cpp -o machine-fleet-benchmark
+
+The built-in machines print from brew(), so the fleet is made of three small machines that
+count their own cups instead, registered as prototypes next to them. Both fleets are built
+from the same random sequence of types, the way machines of a real fleet come and go; the
+vector keeps that order, so every brew() is an indirect call the branch predictor can't
+guess, to a machine somewhere on the heap.
+*/
+
+namespace {
+	const std::size_t fleetSize = 10000000;
+	const int brewPasses = 5;
+
+	template <int Kind>
+	class CountingMachine : public Cloneable<CountingMachine<Kind>> {
+		public:
+			void brew() { cups += Kind + 1; }
+
+			long cups = 0;
+	};
+
+	template <typename Brew>
+	void measure(const char *name, Brew brew) {
+		bench::Clock::time_point start = bench::Clock::now();
+		for (int pass = 0; pass < brewPasses; pass++) {
+			brew();
+		}
+		bench::report(name, double(fleetSize) * brewPasses, bench::secondsSince(start));
+	}
+
+	// Each machine brews Kind + 1 cups per brew(), and every run brews it brewPasses times.
+	template <int Kind>
+	bool cupsOk(const MachineFleet &fleet, long runs) {
+		for (const CountingMachine<Kind> &machine : fleet.machinesOf<CountingMachine<Kind>>()) {
+			if (machine.cups != (Kind + 1) * brewPasses * runs) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool check(bool ok, const char *what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+		}
+		return ok;
+	}
+}
+
+int main() {
+	CoffeeMachineManager::TypeId kinds[] = {
+		CoffeeMachineManager::registerPrototype("counting-0", std::make_unique<CountingMachine<0>>()),
+		CoffeeMachineManager::registerPrototype("counting-1", std::make_unique<CountingMachine<1>>()),
+		CoffeeMachineManager::registerPrototype("counting-2", std::make_unique<CountingMachine<2>>()),
+	};
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> pickKind(0, 2);
+	std::vector<int> order(fleetSize);
+	std::size_t kindCounts[3] = {};
+	for (int &kind : order) {
+		kind = pickKind(random);
+		kindCounts[kind]++;
+	}
+
+	std::vector<CoffeeMachine*> pointers;
+	bench::Clock::time_point start = bench::Clock::now();
+	pointers.reserve(fleetSize);
+	for (int kind : order) {
+		pointers.push_back(CoffeeMachineManager::createMachine(kinds[kind]));
+	}
+	bench::report("build: vector<CoffeeMachine*>, createMachine", fleetSize, bench::secondsSince(start));
+
+	MachineFleet fleet;
+	start = bench::Clock::now();
+	fleet.reserve<CountingMachine<0>>(kindCounts[0]);
+	fleet.reserve<CountingMachine<1>>(kindCounts[1]);
+	fleet.reserve<CountingMachine<2>>(kindCounts[2]);
+	for (int kind : order) {
+		CoffeeMachineManager::createMachine(kinds[kind], fleet);
+	}
+	bench::report("build: MachineFleet, createMachine into it", fleetSize, bench::secondsSince(start));
+	std::printf("\n");
+
+	measure("brew: vector<CoffeeMachine*>", [&] {
+		for (std::size_t i = 0; i < pointers.size(); i++) {
+			pointers[i]->brew();
+		}
+	});
+	measure("brew: MachineFleet, 1 thread", [&] { fleet.brewAll(); });
+
+	std::vector<unsigned> threadCounts = { 2, 4 };
+	if (std::thread::hardware_concurrency() > 4) {
+		threadCounts.push_back(std::thread::hardware_concurrency());
+	}
+	long fleetRuns = 1;
+	for (unsigned threads : threadCounts) {
+		char label[64];
+		std::snprintf(label, sizeof(label), "brew: MachineFleet, %u threads", threads);
+		measure(label, [&] { fleet.brewAll(threads); });
+		fleetRuns++;
+	}
+
+	bool ok = check(fleet.size() == fleetSize && fleet.typeCount() == 3, "the fleet should hold every machine, in three arrays");
+	ok &= check(fleet.machinesOf<CountingMachine<0>>().size() == kindCounts[0] &&
+		fleet.machinesOf<CountingMachine<1>>().size() == kindCounts[1] &&
+		fleet.machinesOf<CountingMachine<2>>().size() == kindCounts[2], "every type should have its own array");
+	ok &= check(cupsOk<0>(fleet, fleetRuns) && cupsOk<1>(fleet, fleetRuns) && cupsOk<2>(fleet, fleetRuns),
+		"every machine should have brewed exactly once per pass, on any number of threads");
+
+	long pointerCups = 0;
+	for (std::size_t i = 0; i < fleetSize; i++) {
+		switch (order[i]) {
+			case 0: pointerCups += static_cast<CountingMachine<0>*>(pointers[i])->cups; break;
+			case 1: pointerCups += static_cast<CountingMachine<1>*>(pointers[i])->cups; break;
+			default: pointerCups += static_cast<CountingMachine<2>*>(pointers[i])->cups; break;
+		}
+		delete pointers[i];
+	}
+	long expectedCups = long(kindCounts[0] + 2 * kindCounts[1] + 3 * kindCounts[2]) * brewPasses;
+	ok &= check(pointerCups == expectedCups, "every pointer should have brewed once per pass");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../common/joining-threads.h"
+
+namespace prototypeDemo {
+
+	class CoffeeMachine;
+
+	/*
+	A fleet of machines of mixed types, stored by type: every machine of one concrete type sits
+	in that type's own contiguous array.
+
+	A std::vector<CoffeeMachine*> of mixed machines brews each one through an indirect call to
+	whichever brew() the next pointer leads to, and chases that pointer to wherever clone() put
+	the machine. The fleet makes one virtual call per type instead, and then runs a plain loop
+	of direct T::brew() calls over that type's array, walking memory in order - the same loop
+	MachineBatch runs for a fleet of a single type.
+
+	The price is that the fleet forgets the order machines were added in: brewAll() brews all
+	machines of the first type added, then all of the second, and so on.
+
+		MachineFleet fleet;
+		CoffeeMachineManager::createMachine(CoffeeMachineManager::espressoMachine, fleet);
+		fleet.add(SimpleCoffeeMachine());
+		fleet.brewAll(4);
+	*/
+	class MachineFleet {
+		struct Lane {
+			virtual ~Lane() = default;
+			virtual std::size_t size() const = 0;
+			virtual void brew(std::size_t begin, std::size_t end) = 0;
+		};
+
+		template <typename T>
+		struct TypedLane : Lane {
+			std::vector<T> machines;
+
+			std::size_t size() const override { return machines.size(); }
+
+			void brew(std::size_t begin, std::size_t end) override {
+				for (std::size_t i = begin; i < end; i++) {
+					machines[i].T::brew(); // qualified, so the compiler calls T::brew directly
+				}
+			}
+		};
+
+		// Its address identifies a type, without RTTI.
+		template <typename T>
+		static inline const char typeTag = 0;
+
+		// One lane per concrete type, in the order the types were first added. Fleets hold
+		// a handful of types, so finding a lane is a short linear search.
+		std::vector<std::unique_ptr<Lane>> lanes;
+		std::vector<const char *> laneTypes;
+		std::size_t machineCount = 0;
+
+		template <typename T>
+		TypedLane<T> *findLane() const {
+			for (std::size_t i = 0; i < lanes.size(); i++) {
+				if (laneTypes[i] == &typeTag<T>) {
+					return static_cast<TypedLane<T> *>(lanes[i].get());
+				}
+			}
+			return nullptr;
+		}
+
+		template <typename T>
+		TypedLane<T> &lane() {
+			static_assert(std::is_base_of_v<CoffeeMachine, T>, "a MachineFleet can only hold machines");
+			if (TypedLane<T> *found = findLane<T>()) {
+				return *found;
+			}
+			lanes.push_back(std::make_unique<TypedLane<T>>());
+			laneTypes.push_back(&typeTag<T>);
+			return static_cast<TypedLane<T> &>(*lanes.back());
+		}
+
+		// Brews machines [begin, end) of the whole fleet, counting lane after lane.
+		void brewRange(std::size_t begin, std::size_t end) {
+			std::size_t laneStart = 0;
+			for (const std::unique_ptr<Lane> &lane : lanes) {
+				std::size_t laneEnd = laneStart + lane->size();
+				if (begin < laneEnd && laneStart < end) {
+					lane->brew(std::max(begin, laneStart) - laneStart, std::min(end, laneEnd) - laneStart);
+				}
+				laneStart = laneEnd;
+			}
+		}
+
+		public:
+			// Builds a T straight into its type's array. The reference is good until the next T is added.
+			template <typename T, typename... Args>
+			T &emplace(Args &&...args) {
+				std::vector<T> &machines = lane<T>().machines;
+				machines.emplace_back(std::forward<Args>(args)...);
+				machineCount++;
+				return machines.back();
+			}
+
+			// Copies or moves a concrete machine into the fleet.
+			template <typename T, typename = std::enable_if_t<std::is_base_of_v<CoffeeMachine, std::decay_t<T>>>>
+			std::decay_t<T> &add(T &&machine) {
+				return emplace<std::decay_t<T>>(std::forward<T>(machine));
+			}
+
+			// Makes room for "count" more machines of type T.
+			template <typename T>
+			void reserve(std::size_t count) {
+				std::vector<T> &machines = lane<T>().machines;
+				machines.reserve(machines.size() + count);
+			}
+
+			std::size_t size() const { return machineCount; }
+			std::size_t typeCount() const { return lanes.size(); }
+
+			// Every machine of type T in the fleet, in the order they were added.
+			template <typename T>
+			const std::vector<T> &machinesOf() const {
+				static const std::vector<T> none;
+				TypedLane<T> *found = findLane<T>();
+				return found ? found->machines : none;
+			}
+
+			/*
+			Brews every machine once. With more than one thread, the fleet is cut into equal
+			slices, one per thread, and the calling thread brews the last one; a slice may span
+			the end of one type's array and the start of the next. If a brew() throws, the
+			other slices still finish and the first exception is rethrown here. If a thread can't
+			be started, the ones already running are joined before that exception leaves.
+			*/
+			void brewAll(unsigned threads = 1) {
+				threads = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threads, machineCount)));
+				std::size_t slice = (machineCount + threads - 1) / threads;
+
+				std::mutex errorMutex;
+				std::exception_ptr error;
+				auto work = [&](std::size_t begin) {
+					try {
+						brewRange(begin, std::min(begin + slice, machineCount));
+					} catch (...) {
+						std::lock_guard<std::mutex> lock(errorMutex);
+						if (!error) {
+							error = std::current_exception();
+						}
+					}
+				};
+
+				JoiningThreads workers;
+				for (unsigned t = 0; t + 1 < threads; t++) {
+					workers.start(work, t * slice);
+				}
+				work((threads - 1) * slice);
+				workers.join();
+				if (error) {
+					std::rethrow_exception(error);
+				}
+			}
+	};
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace prototypeDemo {
+
+	/*
+	A per-type object pool for cloned machines.
+
+	Memory is carved out of slabs of "slabSize" objects and never handed back to the heap;
+	a destroyed object's storage goes onto a free list and is reused by the next clone.
+	Each thread keeps its own free list, so the common case - clone, use, destroy on the same
+	thread - takes no lock at all. When a thread's list grows too long (because it frees objects
+	that other threads allocated) it hands half of it to a shared depot, and a thread that runs
+	dry refills from the depot before it carves a new slab.
+	*/
+	template <typename T, std::size_t slabSize = 64>
+	class MachinePool {
+		// Storage for one object. Sized and aligned for T; holds a T while in use.
+		struct alignas(T) Block {
+			unsigned char bytes[sizeof(T)];
+		};
+
+		// Slabs and the depot are shared by every thread, so they sit behind a mutex.
+		struct Shared {
+			std::mutex mutex;
+			std::vector<std::unique_ptr<Block[]>> slabs;
+			std::vector<Block *> depot;
+		};
+
+		static Shared &shared() {
+			static Shared instance;
+			return instance;
+		}
+
+		struct ThreadCache {
+			std::vector<Block *> freeBlocks;
+
+			~ThreadCache() {
+				// Give our free blocks to the depot so other threads can still use them.
+				if (!freeBlocks.empty()) {
+					Shared &pool = shared();
+					std::lock_guard<std::mutex> lock(pool.mutex);
+					pool.depot.insert(pool.depot.end(), freeBlocks.begin(), freeBlocks.end());
+				}
+			}
+		};
+
+		static ThreadCache &threadCache() {
+			thread_local ThreadCache cache;
+			return cache;
+		}
+
+		static void refill(ThreadCache &cache) {
+			Shared &pool = shared();
+			std::lock_guard<std::mutex> lock(pool.mutex);
+
+			if (!pool.depot.empty()) {
+				std::size_t take = std::min(pool.depot.size(), slabSize);
+				cache.freeBlocks.insert(cache.freeBlocks.end(), pool.depot.end() - take, pool.depot.end());
+				pool.depot.resize(pool.depot.size() - take);
+				return;
+			}
+
+			pool.slabs.push_back(std::make_unique<Block[]>(slabSize));
+			Block *slab = pool.slabs.back().get();
+			for (std::size_t i = slabSize; i > 0; i--) {
+				cache.freeBlocks.push_back(&slab[i - 1]);
+			}
+		}
+
+		public:
+			static void *allocate() {
+				ThreadCache &cache = threadCache();
+				if (cache.freeBlocks.empty()) {
+					refill(cache);
+				}
+				Block *block = cache.freeBlocks.back();
+				cache.freeBlocks.pop_back();
+				return block;
+			}
+
+			static void deallocate(void *memory) {
+				ThreadCache &cache = threadCache();
+				cache.freeBlocks.push_back(static_cast<Block *>(memory));
+
+				if (cache.freeBlocks.size() >= 4 * slabSize) {
+					Shared &pool = shared();
+					std::lock_guard<std::mutex> lock(pool.mutex);
+					std::size_t give = cache.freeBlocks.size() / 2;
+					pool.depot.insert(pool.depot.end(), cache.freeBlocks.end() - give, cache.freeBlocks.end());
+					cache.freeBlocks.resize(cache.freeBlocks.size() - give);
+				}
+			}
+
+			// Constructs a T in pooled storage. If the constructor throws, the storage goes back to the pool.
+			template <typename... Args>
+			static T *create(Args &&...args) {
+				void *memory = allocate();
+				try {
+					return new (memory) T(std::forward<Args>(args)...);
+				} catch (...) {
+					deallocate(memory);
+					throw;
+				}
+			}
+
+			static void destroy(T *object) {
+				object->~T();
+				deallocate(object);
+			}
+	};
+}
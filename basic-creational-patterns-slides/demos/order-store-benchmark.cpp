@@ -0,0 +1,139 @@
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../../bench/bench-util.h"
+#include "order-store.h"
+
+using namespace builderDemo;
+
+/*
+Reporting over millions of orders: a std::vector<Coffee> scan vs the columnar CoffeeOrderStore.
+
+Build:
+	g++ -std=c++17 -O3 -march=native order-store-benchmark.cpp -o order-store-benchmark
+
+Both hold the same orders, from a few hundred regular requestors. Each query runs on both,
+and the answers have to agree (costs up to rounding, since the sums are added in another order).
+*/
+
+namespace {
+	const std::size_t orderCount = 5000000;
+	const int repeats = 20;
+
+	int failures = 0;
+
+	void compare(const char* query, double fromVector, double fromStore) {
+		if (std::fabs(fromVector - fromStore) > 1e-9 * std::fabs(fromVector) + 1e-6) {
+			std::printf("FAILED: %s: vector says %.6f, store says %.6f\n", query, fromVector, fromStore);
+			failures++;
+		}
+	}
+
+	template <typename Query>
+	double time(const char* name, Query query) {
+		double result = 0;
+		bench::Clock::time_point start = bench::Clock::now();
+		for (int i = 0; i < repeats; i++) {
+			result = query();
+			bench::doNotOptimize(result);
+		}
+		bench::report(name, double(orderCount) * repeats, bench::secondsSince(start));
+		return result;
+	}
+}
+
+int main() {
+	std::vector<std::string> requestors;
+	for (int i = 0; i < 300; i++) {
+		requestors.push_back("requestor number " + std::to_string(i));
+	}
+
+	// Same orders into both, via the in-place CoffeeOrder for the vector.
+	std::vector<Coffee> coffees;
+	coffees.reserve(orderCount);
+	bench::Clock::time_point start = bench::Clock::now();
+	for (std::size_t i = 0; i < orderCount; i++) {
+		CoffeeOrder order(requestors[i % requestors.size()]);
+		order.costs(2.0 + (i % 17) * 0.25);
+		if (i % 3 != 0) order.makeHot();
+		if (i % 5 < 2) order.addMilk();
+		if (i % 7 == 0) order.addSugar();
+		std::move(order).emplaceInto(coffees);
+	}
+	bench::report("build 5M orders, vector<Coffee>", orderCount, bench::secondsSince(start));
+
+	CoffeeOrderStore store;
+	store.reserve(orderCount);
+	start = bench::Clock::now();
+	for (std::size_t i = 0; i < orderCount; i++) {
+		CoffeeOrderStore::Row row = store.order(requestors[i % requestors.size()]);
+		row.costs(2.0 + (i % 17) * 0.25);
+		if (i % 3 != 0) row.makeHot();
+		if (i % 5 < 2) row.addMilk();
+		if (i % 7 == 0) row.addSugar();
+	}
+	bench::report("build 5M orders, CoffeeOrderStore", orderCount, bench::secondsSince(start));
+
+	std::printf("%-48s %10.1f MB vector<Coffee> (plus one heap name each), %.1f MB store\n\n", "",
+		orderCount * sizeof(Coffee) / 1e6,
+		(orderCount * (sizeof(double) + sizeof(std::uint32_t)) + 3 * orderCount / 8) / 1e6);
+
+	OrderFilter hotWithMilk;
+	hotWithMilk.hot = OrderFilter::Flag::set;
+	hotWithMilk.milk = OrderFilter::Flag::set;
+	hotWithMilk.sugar = OrderFilter::Flag::clear;
+
+	double a = time("sum cost, vector<Coffee>", [&] {
+		double total = 0;
+		for (const Coffee& coffee : coffees) total += coffee.cost;
+		return total;
+	});
+	double b = time("sum cost, CoffeeOrderStore", [&] { return store.totalCost(); });
+	compare("sum cost", a, b);
+
+	a = time("count milk, vector<Coffee>", [&] {
+		std::size_t total = 0;
+		for (const Coffee& coffee : coffees) total += coffee.hasMilk;
+		return double(total);
+	});
+	OrderFilter withMilk;
+	withMilk.milk = OrderFilter::Flag::set;
+	b = time("count milk, CoffeeOrderStore", [&] { return double(store.count(withMilk)); });
+	compare("count milk", a, b);
+
+	a = time("cost of hot, milk, no sugar, vector<Coffee>", [&] {
+		double total = 0;
+		for (const Coffee& coffee : coffees) {
+			if (coffee.isHot && coffee.hasMilk && !coffee.hasSugar) total += coffee.cost;
+		}
+		return total;
+	});
+	b = time("cost of hot, milk, no sugar, CoffeeOrderStore", [&] { return store.totalCost(hotWithMilk); });
+	compare("cost of hot, milk, no sugar", a, b);
+
+	const std::string& regular = requestors[42];
+	a = time("one requestor's spend, vector<Coffee>", [&] {
+		double total = 0;
+		for (const Coffee& coffee : coffees) {
+			if (coffee.requestor() == regular) total += coffee.cost;
+		}
+		return total;
+	});
+	b = time("one requestor's spend, CoffeeOrderStore", [&] { return store.totalCostFor(regular); });
+	compare("one requestor's spend", a, b);
+
+	std::size_t regularOrders = 0;
+	for (const Coffee& coffee : coffees) regularOrders += coffee.requestor() == regular;
+	compare("orders of one requestor", double(regularOrders), double(store.countFor(regular)));
+	Coffee rebuilt = store.at(12345);
+	const Coffee& original = coffees[12345];
+	if (rebuilt.requestor() != original.requestor() || rebuilt.isHot != original.isHot || rebuilt.hasMilk != original.hasMilk
+		|| rebuilt.hasSugar != original.hasSugar || rebuilt.cost != original.cost) {
+		std::printf("FAILED: store.at() doesn't give back the order that went in\n");
+		failures++;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,284 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "builder.h"
+
+namespace builderDemo {
+
+	/*
+	Millions of orders kept as columns instead of Coffee objects, for reporting jobs that scan them.
+
+	Each flag is a bitset - one bit per order, 64 orders per word - so counting orders with milk
+	is a popcount per word. Costs are one contiguous column of doubles, and requestors are small
+	IDs into a table that stores every distinct name once.
+
+	Orders are written straight into the columns, with the same steps as the Coffee builders:
+
+		CoffeeOrderStore store;
+		store.order("Zachary").makeHot().addMilk().costs(4.00);
+
+	Rows can't be removed; a store is filled, queried and thrown away.
+	*/
+
+	// Which orders a query looks at: each flag must be set, must be clear, or doesn't matter.
+	struct OrderFilter {
+		enum class Flag : unsigned char { any, set, clear };
+
+		Flag hot = Flag::any;
+		Flag milk = Flag::any;
+		Flag sugar = Flag::any;
+	};
+
+	// Every distinct requestor name, once, with a dense ID.
+	class RequestorNames {
+		std::deque<std::string> names; // a deque never moves its elements, so the index can point into it
+		std::unordered_map<std::string_view, std::uint32_t> index;
+
+		public:
+			RequestorNames() = default;
+
+			// The index points into the deque it was built over, so a copy builds its own.
+			RequestorNames(const RequestorNames& other) : names(other.names) {
+				index.reserve(names.size());
+				for (std::size_t id = 0; id < names.size(); id++) {
+					index.emplace(names[id], static_cast<std::uint32_t>(id));
+				}
+			}
+
+			// Moving a deque hands over its elements where they are, so the index stays valid.
+			RequestorNames(RequestorNames&&) = default;
+
+			RequestorNames& operator=(RequestorNames other) {
+				names.swap(other.names);
+				index.swap(other.index);
+				return *this;
+			}
+
+			std::uint32_t intern(std::string_view name) {
+				auto found = index.find(name);
+				if (found != index.end()) {
+					return found->second;
+				}
+				std::uint32_t id = static_cast<std::uint32_t>(names.size());
+				names.emplace_back(name);
+				index.emplace(names.back(), id);
+				return id;
+			}
+
+			// Returns false if nobody of that name has ordered.
+			bool find(std::string_view name, std::uint32_t& id) const {
+				auto found = index.find(name);
+				if (found == index.end()) {
+					return false;
+				}
+				id = found->second;
+				return true;
+			}
+
+			const std::string& name(std::uint32_t id) const { return names.at(id); }
+			std::size_t size() const { return names.size(); }
+	};
+
+	class CoffeeOrderStore {
+		static constexpr std::size_t bitsPerWord = 64;
+
+		std::vector<std::uint64_t> hotBits;
+		std::vector<std::uint64_t> milkBits;
+		std::vector<std::uint64_t> sugarBits;
+		std::vector<double> costColumn;
+		std::vector<std::uint32_t> requestorColumn;
+		RequestorNames requestors;
+
+		static std::size_t popcount(std::uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_popcountll(bits);
+#else
+			std::size_t count = 0;
+			for (; bits != 0; bits &= bits - 1) {
+				count++;
+			}
+			return count;
+#endif
+		}
+
+		static bool test(const std::vector<std::uint64_t>& bits, std::size_t row) {
+			return (bits[row / bitsPerWord] >> (row % bitsPerWord)) & 1;
+		}
+
+		static void set(std::vector<std::uint64_t>& bits, std::size_t row) {
+			bits[row / bitsPerWord] |= std::uint64_t(1) << (row % bitsPerWord);
+		}
+
+		// Bits of word "word" selected by "filter". Bits past the last order are always clear.
+		std::uint64_t matching(const OrderFilter& filter, std::size_t word) const {
+			std::uint64_t mask = ~std::uint64_t(0);
+			std::size_t rowsLeft = size() - word * bitsPerWord;
+			if (rowsLeft < bitsPerWord) {
+				mask = (std::uint64_t(1) << rowsLeft) - 1;
+			}
+			auto apply = [&mask, word](OrderFilter::Flag flag, const std::vector<std::uint64_t>& bits) {
+				if (flag == OrderFilter::Flag::set) {
+					mask &= bits[word];
+				} else if (flag == OrderFilter::Flag::clear) {
+					mask &= ~bits[word];
+				}
+			};
+			apply(filter.hot, hotBits);
+			apply(filter.milk, milkBits);
+			apply(filter.sugar, sugarBits);
+			return mask;
+		}
+
+		public:
+			// One row being written. Like CoffeeOrder, but the steps go straight into the store's columns.
+			class Row {
+				CoffeeOrderStore& store;
+				std::size_t row;
+
+				public:
+					Row(CoffeeOrderStore& store, std::size_t row) : store(store), row(row) {}
+
+					Row& makeHot() { set(store.hotBits, row); return *this; }
+					Row& addMilk() { set(store.milkBits, row); return *this; }
+					Row& addSugar() { set(store.sugarBits, row); return *this; }
+					Row& costs(double cost) { store.costColumn[row] = cost; return *this; }
+
+					std::size_t index() const { return row; }
+			};
+
+			void reserve(std::size_t orders) {
+				std::size_t words = (orders + bitsPerWord - 1) / bitsPerWord;
+				hotBits.reserve(words);
+				milkBits.reserve(words);
+				sugarBits.reserve(words);
+				costColumn.reserve(orders);
+				requestorColumn.reserve(orders);
+			}
+
+			// Starts a new order: not hot, no milk, no sugar, free until costs() says otherwise.
+			Row order(std::string_view requestorName) {
+				std::size_t row = costColumn.size();
+				if (row % bitsPerWord == 0) {
+					hotBits.push_back(0);
+					milkBits.push_back(0);
+					sugarBits.push_back(0);
+				}
+				costColumn.push_back(0);
+				requestorColumn.push_back(requestors.intern(requestorName));
+				return Row(*this, row);
+			}
+
+			Row append(const Coffee& coffee) {
+				Row row = order(coffee.requestor());
+				if (coffee.isHot) row.makeHot();
+				if (coffee.hasMilk) row.addMilk();
+				if (coffee.hasSugar) row.addSugar();
+				return row.costs(coffee.cost);
+			}
+
+			std::size_t size() const { return costColumn.size(); }
+			const RequestorNames& names() const { return requestors; }
+
+			// Rebuilds one order as a Coffee. Throws std::out_of_range for a bad row.
+			Coffee at(std::size_t row) const {
+				if (row >= size()) {
+					throw std::out_of_range("CoffeeOrderStore: no order " + std::to_string(row));
+				}
+				return Coffee(requestors.name(requestorColumn[row]),
+					test(hotBits, row), test(milkBits, row), test(sugarBits, row), costColumn[row]);
+			}
+
+			// Aggregates. Written so the compiler can vectorize them: popcounts over whole words,
+			// and several independent partial sums instead of one long chain of dependent adds.
+
+			std::size_t count(const OrderFilter& filter = {}) const {
+				std::size_t total = 0;
+				for (std::size_t word = 0; word < hotBits.size(); word++) {
+					total += popcount(matching(filter, word));
+				}
+				return total;
+			}
+
+			double totalCost() const {
+				constexpr std::size_t lanes = 8;
+				std::array<double, lanes> partial{};
+				const double* costs = costColumn.data();
+				std::size_t rows = size();
+				std::size_t row = 0;
+				for (; row + lanes <= rows; row += lanes) {
+					for (std::size_t lane = 0; lane < lanes; lane++) {
+						partial[lane] += costs[row + lane];
+					}
+				}
+				double total = 0;
+				for (; row < rows; row++) {
+					total += costs[row];
+				}
+				for (double sum : partial) {
+					total += sum;
+				}
+				return total;
+			}
+
+			// Cost of the orders the filter selects: each cost is multiplied by its 0/1 bit, so there is no branch per order.
+			double totalCost(const OrderFilter& filter) const {
+				constexpr std::size_t lanes = 8;
+				std::array<double, lanes> partial{};
+				const double* costs = costColumn.data();
+				for (std::size_t word = 0; word < hotBits.size(); word++) {
+					std::uint64_t mask = matching(filter, word);
+					if (mask == 0) {
+						continue;
+					}
+					const double* wordCosts = costs + word * bitsPerWord;
+					std::size_t rows = std::min(bitsPerWord, size() - word * bitsPerWord);
+					for (std::size_t bit = 0; bit < rows; bit++) {
+						partial[bit % lanes] += wordCosts[bit] * double((mask >> bit) & 1);
+					}
+				}
+				double total = 0;
+				for (double sum : partial) {
+					total += sum;
+				}
+				return total;
+			}
+
+			// Orders and spend of one requestor; zero for a name that never ordered.
+			std::size_t countFor(std::string_view requestorName) const {
+				std::uint32_t id;
+				if (!requestors.find(requestorName, id)) {
+					return 0;
+				}
+				std::size_t total = 0;
+				for (std::uint32_t requestor : requestorColumn) {
+					total += requestor == id;
+				}
+				return total;
+			}
+
+			double totalCostFor(std::string_view requestorName) const {
+				std::uint32_t id;
+				if (!requestors.find(requestorName, id)) {
+					return 0;
+				}
+				constexpr std::size_t lanes = 8;
+				std::array<double, lanes> partial{};
+				for (std::size_t row = 0; row < size(); row++) {
+					partial[row % lanes] += requestorColumn[row] == id ? costColumn[row] : 0.0;
+				}
+				double total = 0;
+				for (double sum : partial) {
+					total += sum;
+				}
+				return total;
+			}
+	};
+}
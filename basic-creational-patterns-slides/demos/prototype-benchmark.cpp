@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "prototype.h"
+#include "../../bench/alloc-counter.h"
+#include "../../bench/bench-util.h"
+
+using namespace prototypeDemo;
+
+/*
+Clone-heavy workload for the prototype registry: heap clone() + delete against
+pooled clonePooled() handles.
+
+Each thread repeatedly clones a window of mixed machines, keeps them alive together
+(the way a request keeps its machines until it finishes) and then frees the window.
+We run it on one thread and then on every core.
+*/
+static const int clonesPerThread = 4000000;
+static const int window = 256;
+
+template <typename CloneWindow>
+static void run(const char *name, int threads, CloneWindow cloneWindow) {
+	bench::AllocationStats before = bench::AllocationStats::now();
+	auto start = bench::Clock::now();
+
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; t++) {
+		workers.emplace_back([&] {
+			for (int done = 0; done < clonesPerThread; done += window) {
+				cloneWindow();
+			}
+		});
+	}
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+
+	double seconds = bench::secondsSince(start);
+	bench::AllocationStats allocations = bench::AllocationStats::now() - before;
+	double clones = double(clonesPerThread) * threads;
+
+	char label[96];
+	std::snprintf(label, sizeof(label), "%s, %d threads", name, threads);
+	bench::report(label, clones, seconds);
+	std::printf("%-48s %12.4f allocations/clone\n", "", allocations.count / clones);
+}
+
+/*
+Cloning prototypes that carry a payload, from 1 KB to 100 MB of calibration data.
+"deep copy" is what clone() costs when it copies the configuration; "copy-on-write"
+is what it costs now, and "clone + first write" adds the copy paid on first change.
+*/
+template <typename CloneOne>
+static void runPayload(const char *name, std::size_t payloadBytes, int iterations, CloneOne cloneOne) {
+	bench::AllocationStats before = bench::AllocationStats::now();
+	auto start = bench::Clock::now();
+	for (int i = 0; i < iterations; i++) {
+		delete cloneOne();
+	}
+	double seconds = bench::secondsSince(start);
+	bench::AllocationStats allocations = bench::AllocationStats::now() - before;
+
+	char label[96];
+	std::snprintf(label, sizeof(label), "%s, %zu KB payload", name, payloadBytes / 1024);
+	bench::report(label, iterations, seconds);
+	std::printf("%-48s %12.0f bytes allocated/clone\n", "", double(allocations.bytes) / iterations);
+}
+
+static void runPayloads() {
+	for (std::size_t payloadBytes : { std::size_t(1) << 10, std::size_t(1) << 16, std::size_t(1) << 20, std::size_t(100) << 20 }) {
+		MachineConfig config;
+		config.recipes.push_back({ "Espresso", 30.0, 18.0, 25 });
+		config.calibration.assign(payloadBytes / sizeof(float), 1.0f);
+		SimpleCoffeeMachine prototype(std::move(config));
+
+		int iterations = static_cast<int>(std::max<std::size_t>(20, (std::size_t(256) << 20) / payloadBytes));
+		iterations = std::min(iterations, 1000000);
+
+		runPayload("deep copy", payloadBytes, iterations, [&] {
+			return new SimpleCoffeeMachine(MachineConfig(prototype.configuration()));
+		});
+		runPayload("copy-on-write clone()", payloadBytes, iterations, [&] {
+			return prototype.clone();
+		});
+		runPayload("copy-on-write clone() + first write", payloadBytes, iterations, [&] {
+			CoffeeMachine *machine = prototype.clone();
+			machine->reconfigure().calibration[0] = 2.0f;
+			return machine;
+		});
+	}
+}
+
+/*
+Registry contention: every thread clones as fast as it can, by type ID or by name,
+while one thread registers a new prototype every millisecond. We compare the
+lock-free registry with the obvious thread-safe alternative, a map behind a mutex.
+*/
+class LockedRegistry {
+	std::mutex mutex;
+	std::map<std::string, std::unique_ptr<CoffeeMachine>, std::less<>> prototypes;
+
+	public:
+		void add(std::string name, std::unique_ptr<CoffeeMachine> prototype) {
+			std::lock_guard<std::mutex> lock(mutex);
+			prototypes.emplace(std::move(name), std::move(prototype));
+		}
+
+		PooledMachine createPooledMachine(std::string_view name) {
+			std::lock_guard<std::mutex> lock(mutex);
+			return prototypes.find(name)->second->clonePooled();
+		}
+};
+
+template <typename CreateOne, typename RegisterOne>
+static void runContention(const char *name, int threads, CreateOne createOne, RegisterOne registerOne) {
+	std::atomic<bool> done{ false };
+	std::atomic<int> registered{ 0 };
+	std::thread registrar([&] {
+		while (!done.load(std::memory_order_relaxed)) {
+			registerOne(registered.fetch_add(1, std::memory_order_relaxed));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+
+	run(name, threads, [&] {
+		for (int i = 0; i < window; i++) {
+			PooledMachine machine = createOne(i);
+			bench::doNotOptimize(machine);
+		}
+	});
+	done = true;
+	registrar.join();
+	std::printf("%-48s %12d prototypes registered meanwhile\n", "", registered.load());
+}
+
+static void runRegistryContention(int threads) {
+	static const char *names[] = { "simple", "complex", "espresso" };
+
+	LockedRegistry locked;
+	for (const char *machineName : names) {
+		locked.add(machineName, std::unique_ptr<CoffeeMachine>(CoffeeMachineManager::createMachine(std::string_view(machineName))));
+	}
+	runContention("createPooledMachine(name), map + mutex", threads,
+		[&](int i) { return locked.createPooledMachine(names[i % 3]); },
+		[&](int n) { locked.add("plugin-locked-" + std::to_string(n), std::make_unique<SimpleCoffeeMachine>()); });
+
+	static std::atomic<int> pluginRun{ 0 };
+	int runNumber = pluginRun.fetch_add(1);
+	runContention("createPooledMachine(name), registry", threads,
+		[&](int i) { return CoffeeMachineManager::createPooledMachine(std::string_view(names[i % 3])); },
+		[&](int n) {
+			CoffeeMachineManager::registerPrototype("plugin-" + std::to_string(runNumber) + "-" + std::to_string(n),
+				std::make_unique<SimpleCoffeeMachine>());
+		});
+	runContention("createPooledMachine(type ID), registry", threads,
+		[&](int i) { return CoffeeMachineManager::createPooledMachine(CoffeeMachineManager::TypeId(i % 3)); },
+		[&](int n) {
+			CoffeeMachineManager::registerPrototype("plugin-id-" + std::to_string(runNumber) + "-" + std::to_string(n),
+				std::make_unique<SimpleCoffeeMachine>());
+		});
+}
+
+/*
+Building and brewing a fleet of identical machines: the per-object loop from
+prototype.cpp's main() against createMachines() + brewAll().
+*/
+static void runFleet(std::size_t fleetSize) {
+	const int rounds = 10;
+	double perObjectCreate = 0, perObjectBrew = 0, batchCreate = 0, batchBrew = 0;
+	bench::SilenceStdout silence;
+
+	for (int round = 0; round < rounds; round++) {
+		auto start = bench::Clock::now();
+		std::vector<CoffeeMachine*> myMachines(fleetSize);
+		for (std::size_t i = 0; i < fleetSize; i++) {
+			myMachines[i] = CoffeeMachineManager::createMachine(CoffeeMachineManager::simpleMachine);
+		}
+		perObjectCreate += bench::secondsSince(start);
+
+		start = bench::Clock::now();
+		for (std::size_t i = 0; i < myMachines.size(); i++) {
+			myMachines[i]->brew();
+		}
+		perObjectBrew += bench::secondsSince(start);
+
+		for (CoffeeMachine* machine : myMachines) {
+			delete machine;
+		}
+
+		start = bench::Clock::now();
+		MachineBatch fleet = CoffeeMachineManager::createMachines(CoffeeMachineManager::simpleMachine, fleetSize);
+		batchCreate += bench::secondsSince(start);
+
+		start = bench::Clock::now();
+		fleet.brewAll();
+		batchBrew += bench::secondsSince(start);
+	}
+
+	double machines = double(fleetSize) * rounds;
+	bench::report("fleet: createMachine() per object", machines, perObjectCreate);
+	bench::report("fleet: createMachines() batch", machines, batchCreate);
+	bench::report("fleet: brew() per object", machines, perObjectBrew);
+	bench::report("fleet: brewAll() batch", machines, batchBrew);
+}
+
+int main() {
+	auto heapWindow = [] {
+		CoffeeMachine *machines[window];
+		for (int i = 0; i < window; i++) {
+			machines[i] = CoffeeMachineManager::createMachine(i % 3);
+		}
+		bench::doNotOptimize(machines);
+		for (int i = 0; i < window; i++) {
+			delete machines[i];
+		}
+	};
+
+	auto pooledWindow = [] {
+		std::vector<PooledMachine> machines;
+		machines.reserve(window);
+		for (int i = 0; i < window; i++) {
+			machines.push_back(CoffeeMachineManager::createPooledMachine(i % 3));
+		}
+		bench::doNotOptimize(machines);
+	};
+
+	int cores = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+	for (int threads : { 1, cores }) {
+		run("heap clone() + delete", threads, heapWindow);
+		run("pooled clonePooled()", threads, pooledWindow);
+		runRegistryContention(threads);
+	}
+
+	runFleet(100000);
+	runPayloads();
+
+	return EXIT_SUCCESS;
+}
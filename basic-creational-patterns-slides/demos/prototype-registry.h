@@ -0,0 +1,319 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../../common/joining-threads.h"
+
+namespace prototypeDemo {
+
+	/*
+	A registry of prototypes, looked up by name or by the numeric type ID handed out at registration.
+
+	Prototypes can be registered at any time, from any thread - by plugins, for example - while other
+	threads keep cloning. Lookups never lock: they read the current table through an atomic pointer.
+	A registration builds a complete new table and swaps it in, so a reader always sees either the
+	old table or the new one, never something half-built.
+
+	A reader announces the table it is searching in a hazard slot of its own, and a writer only
+	deletes a replaced table once no slot points at it any more, the way GlobalCoffeeConfig
+	reclaims its snapshots. The entries themselves live as long as the registry, so a lookup only
+	needs to protect the table while it searches; building a lazy prototype happens after that.
+
+	Prototypes that are expensive to build can be registered as a factory instead, with addLazy().
+	The factory runs once, on the first lookup of that prototype, or earlier if warmUp() gets to it
+	first; whoever builds it publishes it, and concurrent lookups wait for that one build.
+
+	"Prototype" only needs to be a class type; the registry owns the registered objects.
+	*/
+	template <typename Prototype>
+	class PrototypeRegistry {
+		public:
+			using TypeId = std::size_t;
+			using Factory = std::function<std::unique_ptr<Prototype>()>;
+
+		private:
+			// One registered prototype, built already or on first use.
+			struct Entry {
+				std::atomic<Prototype *> published{ nullptr };
+				std::once_flag once;
+				Factory factory;
+				std::unique_ptr<Prototype> prototype;
+
+				// If the factory throws, nothing is published and the next lookup tries again.
+				Prototype &get() {
+					if (Prototype *prototype = published.load(std::memory_order_acquire)) {
+						return *prototype;
+					}
+					std::call_once(once, [this] {
+						std::unique_ptr<Prototype> built = factory();
+						if (!built) {
+							throw std::invalid_argument("PrototypeRegistry: a prototype factory returned null");
+						}
+						prototype = std::move(built);
+						factory = nullptr;
+						published.store(prototype.get(), std::memory_order_release);
+					});
+					return *published.load(std::memory_order_acquire);
+				}
+			};
+
+			struct Table {
+				std::vector<Entry *> byId;
+				// Sorted by name, so lookups by name are a binary search.
+				std::vector<std::pair<std::string, TypeId>> byName;
+			};
+
+			/*
+			Every thread that looks something up gets an index into the hazard slots, shared by all
+			registries, so a registry needs no per-thread bookkeeping of its own. The index is given
+			back when the thread exits; by then it has no hazard published anywhere.
+			*/
+			static constexpr std::size_t maxReaderThreads = 512;
+
+			struct alignas(64) ReaderSlot {
+				std::atomic<const Table *> hazard{ nullptr };
+			};
+
+			struct ThreadIndex {
+				std::size_t index;
+
+				ThreadIndex() : index(claim()) {}
+				~ThreadIndex() { indexInUse[index].store(false, std::memory_order_release); }
+
+				static std::size_t claim() {
+					for (std::size_t i = 0; i < maxReaderThreads; i++) {
+						bool expected = false;
+						if (!indexInUse[i].load(std::memory_order_relaxed) &&
+							indexInUse[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+							return i;
+						}
+					}
+					throw std::runtime_error("PrototypeRegistry: too many concurrent reader threads");
+				}
+			};
+
+			static inline std::atomic<bool> indexInUse[maxReaderThreads] = {};
+
+			static std::size_t threadIndex() {
+				thread_local ThreadIndex index;
+				return index.index;
+			}
+
+			// Publishes the current table in this thread's hazard slot for as long as it lives.
+			class Pin {
+				ReaderSlot &slot;
+
+				public:
+					const Table *table;
+
+					explicit Pin(const PrototypeRegistry &registry) : slot(registry.readerSlots[threadIndex()]) {
+						// Publish the hazard, then check the table wasn't swapped out in between.
+						table = registry.current.load(std::memory_order_seq_cst);
+						for (;;) {
+							slot.hazard.store(table, std::memory_order_seq_cst);
+							const Table *latest = registry.current.load(std::memory_order_seq_cst);
+							if (latest == table) {
+								break;
+							}
+							table = latest;
+						}
+					}
+
+					~Pin() { slot.hazard.store(nullptr, std::memory_order_release); }
+
+					Pin(const Pin &) = delete;
+					Pin &operator=(const Pin &) = delete;
+			};
+
+			std::atomic<const Table *> current;
+			std::unique_ptr<ReaderSlot[]> readerSlots;
+
+			// Everything below is only touched by writers, under "writerMutex".
+			std::mutex writerMutex;
+			std::vector<std::unique_ptr<Entry>> entries;
+			std::vector<const Table *> retired;
+
+		public:
+			PrototypeRegistry() : current(new Table()), readerSlots(new ReaderSlot[maxReaderThreads]) {}
+
+			PrototypeRegistry(const PrototypeRegistry &) = delete;
+			PrototypeRegistry &operator=(const PrototypeRegistry &) = delete;
+
+			~PrototypeRegistry() {
+				delete current.load();
+				for (const Table *table : retired) {
+					delete table;
+				}
+			}
+
+			// Adds a prototype and returns its type ID. Throws std::invalid_argument if the name is taken.
+			TypeId add(std::string name, std::unique_ptr<Prototype> prototype) {
+				if (!prototype) {
+					throw std::invalid_argument("PrototypeRegistry: null prototype for \"" + name + "\"");
+				}
+				auto entry = std::make_unique<Entry>();
+				entry->prototype = std::move(prototype);
+				entry->published.store(entry->prototype.get(), std::memory_order_relaxed);
+				return insert(std::move(name), std::move(entry));
+			}
+
+			// Adds a prototype that "factory" builds when it is first needed. Same type IDs and errors as add().
+			TypeId addLazy(std::string name, Factory factory) {
+				if (!factory) {
+					throw std::invalid_argument("PrototypeRegistry: null factory for \"" + name + "\"");
+				}
+				auto entry = std::make_unique<Entry>();
+				entry->factory = std::move(factory);
+				return insert(std::move(name), std::move(entry));
+			}
+
+			/*
+			Builds every prototype that hasn't been built yet, spread over "threads" threads, and
+			returns once they are all published. Lookups from other threads may run meanwhile: one
+			that needs a prototype still being built waits for it, and one that gets there first
+			builds it itself. Rethrows the first exception a factory threw. If a thread can't be
+			started, the ones already running are joined before that exception leaves.
+			*/
+			void warmUp(unsigned threads = std::thread::hardware_concurrency()) {
+				std::vector<Entry *> pending;
+				{
+					Pin pin(*this);
+					for (Entry *entry : pin.table->byId) {
+						if (!entry->published.load(std::memory_order_acquire)) {
+							pending.push_back(entry);
+						}
+					}
+				}
+				threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(pending.size())));
+
+				std::atomic<std::size_t> next{ 0 };
+				std::mutex errorMutex;
+				std::exception_ptr error;
+				auto work = [&] {
+					for (std::size_t i = next++; i < pending.size(); i = next++) {
+						try {
+							pending[i]->get();
+						} catch (...) {
+							std::lock_guard<std::mutex> lock(errorMutex);
+							if (!error) {
+								error = std::current_exception();
+							}
+						}
+					}
+				};
+
+				JoiningThreads workers;
+				for (unsigned t = 1; t < threads; t++) {
+					workers.start(work);
+				}
+				work();
+				workers.join();
+				if (error) {
+					std::rethrow_exception(error);
+				}
+			}
+
+			// Whether the prototype has been built yet. Unknown type IDs are never built.
+			bool built(TypeId id) const {
+				Entry *entry = entryFor(id);
+				return entry && entry->published.load(std::memory_order_acquire);
+			}
+
+			// Returns nullptr for an unknown type ID. A lazy prototype is built here on its first lookup.
+			Prototype *find(TypeId id) const {
+				Entry *entry = entryFor(id);
+				return entry ? &entry->get() : nullptr;
+			}
+
+			// Returns nullptr for an unknown name.
+			Prototype *find(std::string_view name) const {
+				Entry *entry = entryFor(name);
+				return entry ? &entry->get() : nullptr;
+			}
+
+			// Like find(), but an unknown type is an error: throws std::out_of_range.
+			Prototype &at(TypeId id) const {
+				if (Prototype *prototype = find(id)) {
+					return *prototype;
+				}
+				throw std::out_of_range("PrototypeRegistry: no prototype with type ID " + std::to_string(id));
+			}
+
+			Prototype &at(std::string_view name) const {
+				if (Prototype *prototype = find(name)) {
+					return *prototype;
+				}
+				throw std::out_of_range("PrototypeRegistry: no prototype named \"" + std::string(name) + "\"");
+			}
+
+			std::size_t size() const {
+				Pin pin(*this);
+				return pin.table->byId.size();
+			}
+
+		private:
+			Entry *entryFor(TypeId id) const {
+				Pin pin(*this);
+				return id < pin.table->byId.size() ? pin.table->byId[id] : nullptr;
+			}
+
+			Entry *entryFor(std::string_view name) const {
+				Pin pin(*this);
+				const Table *table = pin.table;
+				auto position = std::lower_bound(table->byName.begin(), table->byName.end(), name,
+					[](const std::pair<std::string, TypeId> &entry, std::string_view key) { return entry.first < key; });
+				if (position == table->byName.end() || position->first != name) {
+					return nullptr;
+				}
+				return table->byId[position->second];
+			}
+
+			TypeId insert(std::string name, std::unique_ptr<Entry> entry) {
+				std::lock_guard<std::mutex> lock(writerMutex);
+				const Table *previous = current.load(std::memory_order_relaxed);
+
+				auto position = std::lower_bound(previous->byName.begin(), previous->byName.end(), name,
+					[](const std::pair<std::string, TypeId> &existing, const std::string &key) { return existing.first < key; });
+				if (position != previous->byName.end() && position->first == name) {
+					throw std::invalid_argument("PrototypeRegistry: \"" + name + "\" is already registered");
+				}
+
+				auto next = std::make_unique<Table>(*previous);
+				TypeId id = next->byId.size();
+				next->byId.push_back(entry.get());
+				next->byName.insert(next->byName.begin() + (position - previous->byName.begin()), { std::move(name), id });
+
+				entries.push_back(std::move(entry));
+				retired.reserve(retired.size() + 1);
+				current.store(next.release(), std::memory_order_seq_cst);
+				retired.push_back(previous);
+				reclaimRetired();
+				return id;
+			}
+
+			// Deletes every retired table that no reader is searching any more. Called with writerMutex held.
+			void reclaimRetired() {
+				auto stillInUse = std::remove_if(retired.begin(), retired.end(), [this](const Table *table) {
+					for (std::size_t i = 0; i < maxReaderThreads; i++) {
+						if (readerSlots[i].hazard.load(std::memory_order_seq_cst) == table) {
+							return false;
+						}
+					}
+					delete table;
+					return true;
+				});
+				retired.erase(stillInUse, retired.end());
+			}
+	};
+}
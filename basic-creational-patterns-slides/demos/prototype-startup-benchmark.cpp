@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "prototype.h"
+#include "../../bench/bench-util.h"
+
+using namespace prototypeDemo;
+
+/*
+Startup cost of a registry of expensive prototypes: building them all up front, one after
+another (what a registry of add() calls does), against building each on its first clone,
+and against warming them up in parallel - before serving, or in the background while the
+first clones are already being made.
+
+Build:
+	g++ -std=c++17 -O2 -pthread prototype-startup-benchmark.cpp -o prototype-startup-benchmark
+
+Each prototype computes its own calibration table, which is what makes it expensive.
+For every mode we report, from the moment the registry is created:
+	startup      - until the program can start serving clones,
+	first clone  - until the first machine has been cloned,
+	all types    - until one machine of every type has been cloned.
+*/
+
+namespace {
+	const int prototypeCount = 12;
+	const std::size_t calibrationPoints = 1 << 20;
+
+	std::atomic<int> prototypesBuilt{ 0 };
+
+	float calibrationPoint(int type, std::size_t point) {
+		return static_cast<float>(std::sin(double(point) * 0.001 + type) * std::exp(-double(point) * 1e-7));
+	}
+
+	std::unique_ptr<CoffeeMachine> buildPrototype(int type) {
+		MachineConfig config;
+		config.recipes.push_back({ "Recipe " + std::to_string(type), 30.0 + type, 18.0, 25 });
+		config.calibration.resize(calibrationPoints);
+		for (std::size_t point = 0; point < calibrationPoints; point++) {
+			config.calibration[point] = calibrationPoint(type, point);
+		}
+		prototypesBuilt++;
+		return std::make_unique<EspressoMachine>(std::move(config));
+	}
+
+	std::string typeName(int type) {
+		return "machine-" + std::to_string(type);
+	}
+
+	double millisecondsSince(bench::Clock::time_point start) {
+		return bench::secondsSince(start) * 1e3;
+	}
+
+	// A clone is only correct if it carries its own type's configuration.
+	bool cloneOk(PrototypeRegistry<CoffeeMachine> &registry, int type) {
+		std::unique_ptr<CoffeeMachine> machine(registry.at(PrototypeRegistry<CoffeeMachine>::TypeId(type)).clone());
+		const MachineConfig &config = machine->configuration();
+		return config.recipes.size() == 1 && config.recipes[0].waterMl == 30.0 + type &&
+			config.calibration.size() == calibrationPoints &&
+			config.calibration[calibrationPoints / 2] == calibrationPoint(type, calibrationPoints / 2);
+	}
+
+	/*
+	"start" fills the registry, and returns a function that is called once the first
+	clones are done - to wait for a background warm-up, say. Returns false if any clone
+	was wrong or a prototype was built more than once.
+	*/
+	template <typename Start>
+	bool run(const char *name, Start start) {
+		prototypesBuilt = 0;
+		bool ok = true;
+
+		bench::Clock::time_point begin = bench::Clock::now();
+		PrototypeRegistry<CoffeeMachine> registry;
+		auto finish = start(registry);
+		double startup = millisecondsSince(begin);
+
+		ok &= cloneOk(registry, 0);
+		double firstClone = millisecondsSince(begin);
+
+		for (int type = 1; type < prototypeCount; type++) {
+			ok &= cloneOk(registry, type);
+		}
+		double allTypes = millisecondsSince(begin);
+		finish();
+
+		std::printf("%-40s startup %8.2f ms   first clone %8.2f ms   all types %8.2f ms\n", name, startup, firstClone, allTypes);
+		if (prototypesBuilt != prototypeCount) {
+			std::printf("FAILED: %s built %d prototypes instead of %d\n", name, prototypesBuilt.load(), prototypeCount);
+			ok = false;
+		}
+		if (!ok) {
+			std::printf("FAILED: %s handed out a wrong clone\n", name);
+		}
+		return ok;
+	}
+
+	void registerLazily(PrototypeRegistry<CoffeeMachine> &registry) {
+		for (int type = 0; type < prototypeCount; type++) {
+			registry.addLazy(typeName(type), [type] { return buildPrototype(type); });
+		}
+	}
+}
+
+int main() {
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	std::printf("%d prototypes, %zu calibration points each, warm-up on %u threads\n\n", prototypeCount, calibrationPoints, threads);
+
+	bool ok = true;
+	ok &= run("eager, serial (add)", [](PrototypeRegistry<CoffeeMachine> &registry) {
+		for (int type = 0; type < prototypeCount; type++) {
+			registry.add(typeName(type), buildPrototype(type));
+		}
+		return [] {};
+	});
+
+	ok &= run("lazy, on first clone (addLazy)", [](PrototypeRegistry<CoffeeMachine> &registry) {
+		registerLazily(registry);
+		return [] {};
+	});
+
+	ok &= run("parallel warm-up before serving", [threads](PrototypeRegistry<CoffeeMachine> &registry) {
+		registerLazily(registry);
+		registry.warmUp(threads);
+		return [] {};
+	});
+
+	ok &= run("parallel warm-up in the background", [threads](PrototypeRegistry<CoffeeMachine> &registry) {
+		registerLazily(registry);
+		auto warmUp = std::make_shared<std::thread>([&registry, threads] { registry.warmUp(threads); });
+		return [warmUp] { warmUp->join(); };
+	});
+
+	// Many threads asking for the same unbuilt prototype at once: one builds it, the rest wait.
+	prototypesBuilt = 0;
+	{
+		PrototypeRegistry<CoffeeMachine> registry;
+		registerLazily(registry);
+		std::atomic<int> wrong{ 0 };
+		std::vector<std::thread> clients;
+		for (int client = 0; client < 16; client++) {
+			clients.emplace_back([&registry, &wrong, client] {
+				wrong += !cloneOk(registry, client % 2);
+			});
+		}
+		for (std::thread &client : clients) {
+			client.join();
+		}
+		if (wrong != 0 || prototypesBuilt != 2 || !registry.built(0) || !registry.built(1) || registry.built(2)) {
+			std::printf("FAILED: concurrent first clones built %d prototypes, %d clones were wrong\n", prototypesBuilt.load(), wrong.load());
+			ok = false;
+		}
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,92 +1,12 @@
 #include <iostream>
 #include <vector>
+#include "prototype.h"
 
-// Abstract base class - This is our prototype which contains a "clone" method
-class CoffeeMachine {
-	public:
-	//Important to observe the Abstract contains the clone() method.
-	//This clone method along with brew method need to be implemented by derived classes.
-		virtual CoffeeMachine* clone() = 0;
-		virtual void brew() = 0;
-};
+using namespace prototypeDemo;
 
-// Concrete implementations of the prototype - in practice, these would be "complex" objects that cost a lot to instantiate
-class SimpleCoffeeMachine : public CoffeeMachine {
-	public:
-		CoffeeMachine*   clone() {
-			return new SimpleCoffeeMachine;
-		}
-
-		void brew() {
-			std::cout << "Brewing simple coffee!\n";
-		}
-};
-
-class ComplexCoffeeMachine : public CoffeeMachine {
-	public:
-		CoffeeMachine*   clone() {
-			return new ComplexCoffeeMachine; 
-		}
-
-		void brew() {
-			std::cout << "Brewing complex coffee!\n";
-		}
-};
-
-class EspressoMachine : public CoffeeMachine {
-	public:
-		CoffeeMachine*   clone() {
-			return new EspressoMachine;
-		}
-
-		void brew() {
-			std::cout << "Brewing espresso!\n";
-		}
-};
-/** 
- * For the above implementations, the clone method of each class creates a brand new machine of that type
- * on the heap using the new keyword.
- * This is the function where you can add your own flavour as to how you want objects to be cloned
- * according to the pattern.
- * For this simple example, we simply use the new keyword to allocate memory for these objects on the heap.
- */
-
-// Helper, management class which can abstract the creation of objects via their type.
+// The prototypes and CoffeeMachineManager live in prototype.h so that
+// the benchmarks can share them with this demo.
 
-/*
-Further down below, we have our CoffeeMachineManager class. 
-Although not necessarily required to implement this pattern, it often becomes necessary 
-in order to successfully create the abstraction around creating objects irrespective of type. 
-This class provides a static method for creating new coffee machines in a generic way. 
-This simple version simply uses an integer to select the right type, although templates and/or enums 
-in combination with the switch statement are also good choices. 
-*/
-class CoffeeMachineManager {
-	public:
-		static CoffeeMachine* createMachine( int machineType );
-		~CoffeeMachineManager(){}
-
-	private:
-		static CoffeeMachine* machines[3];
-};
-
-// The management class contains already instantiated objects so that new objects requested are simply cloned!
-
-//The magic here is in the statically allocated machines field. 
-//A bit further down, we populated this static array with one of 
-//each of our concrete prototype classes.
-CoffeeMachine* CoffeeMachineManager::machines[] =  {
-	new SimpleCoffeeMachine, new ComplexCoffeeMachine, new EspressoMachine
-};
-
-//The createMachine method then becomes our one‑stop‑shop in 
-//terms of creating objects from our prototype.
-
-// This helper method will ensure that new machines are not created from scratch but are simply cloned instead
-CoffeeMachine* CoffeeMachineManager::createMachine( int machineType ) 
-{
-   return machines[machineType]->clone();
-}
 /*
 From the foundation of these three objects that have already been instantiated,
 we are simply cloning here. This really helps when your objects are big and contain lots of data,
@@ -103,7 +23,7 @@ int main() {
 	myMachines[1] = complexMachine;
 	myMachines[2] = espressoMachine;
 
-   for (int i = 0; i < myMachines.size(); i++) {
+   for (std::size_t i = 0; i < myMachines.size(); i++) {
 		myMachines[i]->brew();
    }
 
@@ -112,11 +32,47 @@ int main() {
    clonedMachine->brew();
 
 	// Clean up!
-	for (int i = 0; i < myMachines.size(); i++) {
+	for (std::size_t i = 0; i < myMachines.size(); i++) {
 		delete myMachines[i];
 	}
 
 	delete clonedMachine;
+
+	// Clones share the prototype's configuration until they change it
+	CoffeeMachine* customMachine = CoffeeMachineManager::createMachine(1);
+	customMachine->reconfigure().recipes.push_back({ "Flat white", 150.0, 18.0, 28 });
+	std::cout << "Custom machine knows " << customMachine->configuration().recipes.size() << " recipe(s)\n";
+	delete customMachine;
+
+	// New prototypes can be registered at runtime, and any prototype can be cloned by name
+	MachineConfig cortado;
+	cortado.recipes.push_back({ "Cortado", 60.0, 18.0, 25 });
+	CoffeeMachineManager::registerPrototype("cortado", std::make_unique<EspressoMachine>(cortado));
+	CoffeeMachine* cortadoMachine = CoffeeMachineManager::createMachine("cortado");
+	std::cout << "Cortado machine's first recipe: " << cortadoMachine->configuration().recipes[0].name << "\n";
+	delete cortadoMachine;
+
+	// A whole fleet of identical machines can be cloned in one go, and brewed in one go
+	MachineBatch fleet = CoffeeMachineManager::createMachines(CoffeeMachineManager::simpleMachine, 2);
+	fleet.brewAll();
+
+	// Pooled clones clean up after themselves - no delete needed,
+	// and their storage is reused by the next clone of the same type
+	PooledMachine pooledMachine = CoffeeMachineManager::createPooledMachine(2);
+	pooledMachine->brew();
+
+	// Or held by value: a machine this small lives inside the handle, with no heap allocation,
+	// and copying the handle clones the machine
+	AnyCoffeeMachine anyMachine = CoffeeMachineManager::createAnyMachine(CoffeeMachineManager::complexMachine);
+	AnyCoffeeMachine anotherMachine = anyMachine;
+	anotherMachine->brew();
+
+	// A fleet of mixed machines keeps each type together, and brews one type after another
+	MachineFleet mixedFleet;
+	CoffeeMachineManager::createMachine(CoffeeMachineManager::espressoMachine, mixedFleet);
+	CoffeeMachineManager::createMachine(CoffeeMachineManager::simpleMachine, mixedFleet);
+	CoffeeMachineManager::createMachine(CoffeeMachineManager::espressoMachine, mixedFleet);
+	mixedFleet.brewAll();
 /*
 I hope that this example has shown you how valuable the 
 prototype design pattern can be.
@@ -0,0 +1,341 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "../../common/any-machine.h"
+#include "../../instrumentation/creation-stats.h"
+#include "copy-on-write.h"
+#include "machine-batch.h"
+#include "machine-config.h"
+#include "machine-fleet.h"
+#include "machine-pool.h"
+#include "prototype-registry.h"
+
+namespace prototypeDemo {
+
+	class CoffeeMachine;
+
+	/*
+	Pooled clones come back as a PooledMachine: a unique_ptr whose deleter returns the
+	machine to the pool of its concrete type instead of calling delete.
+	*/
+	struct PooledMachineDeleter {
+		void (*recycle)(CoffeeMachine *) = nullptr;
+
+		void operator()(CoffeeMachine *machine) const { recycle(machine); }
+	};
+
+	using PooledMachine = std::unique_ptr<CoffeeMachine, PooledMachineDeleter>;
+
+	// A machine held by value, inside the handle when it is small enough (see common/any-machine.h).
+	using AnyCoffeeMachine = BasicAnyCoffeeMachine<CoffeeMachine>;
+
+	// Builds a T in its type's pool.
+	template <typename T, typename... Args>
+	PooledMachine makePooled(Args &&...args) {
+		T *machine = MachinePool<T>::create(std::forward<Args>(args)...);
+		return PooledMachine(machine, PooledMachineDeleter{ [](CoffeeMachine *pooled) {
+			MachinePool<T>::destroy(static_cast<T *>(pooled));
+		} });
+	}
+
+	// Abstract base class - This is our prototype which contains a "clone" method
+	class CoffeeMachine {
+		public:
+		//Important to observe the Abstract contains the clone() method.
+		//The brew method needs to be implemented by derived classes; deriving from
+		//Cloneable (below) implements clone() and its variants for them.
+			virtual CoffeeMachine* clone() = 0;
+			virtual void brew() = 0;
+
+		//clonePooled() is the same clone, but taken from a per-type pool instead of
+		//the heap. Use it when machines are cloned and thrown away at a high rate.
+			virtual PooledMachine clonePooled() = 0;
+
+		//cloneBatch() clones the machine "count" times into one contiguous block.
+			virtual MachineBatch cloneBatch(std::size_t count) = 0;
+
+		//cloneAny() hands the clone back by value. Our machines fit inside the
+		//handle, so this clone needs no heap allocation at all.
+			virtual AnyCoffeeMachine cloneAny() = 0;
+
+		//cloneInto() adds the clone to a MachineFleet, in the array of its own type.
+			virtual void cloneInto(MachineFleet& fleet) = 0;
+
+			virtual ~CoffeeMachine() = default;
+
+		//Every machine carries its configuration. Clones share it with their prototype
+		//until one of them changes it, so cloning a machine with a large recipe table or
+		//calibration array costs the same as cloning an empty one.
+			CoffeeMachine() = default;
+			explicit CoffeeMachine(MachineConfig config) : config(std::move(config)) {}
+
+		//The virtual destructor above would otherwise turn every move of a machine into a copy.
+			CoffeeMachine(const CoffeeMachine&) = default;
+			CoffeeMachine(CoffeeMachine&&) noexcept = default;
+			CoffeeMachine& operator=(const CoffeeMachine&) = default;
+			CoffeeMachine& operator=(CoffeeMachine&&) noexcept = default;
+
+			const MachineConfig& configuration() const { return config.read(); }
+
+			// Writing makes this machine's own copy of the configuration first, if it's still shared
+			MachineConfig& reconfigure() { return config.write(); }
+
+			bool sharesConfiguration() const { return config.shared(); }
+
+		private:
+			CopyOnWrite<MachineConfig> config;
+	};
+
+	/*
+	Every clone variant, written once. A concrete machine derives from Cloneable<itself> and
+	only has to be copyable: each variant copies the machine as its real type, wherever that
+	variant puts the copy. Plugin prototypes get all of them for free the same way.
+
+	The instrumentation labels the copies with Derived::productName, which a machine can
+	declare to be told apart from other machines.
+	*/
+	template <typename Derived>
+	class Cloneable : public CoffeeMachine {
+		public:
+			static constexpr const char *productName = "CoffeeMachine";
+
+			using CoffeeMachine::CoffeeMachine;
+
+		//The clone() method of the pattern: a new machine on the heap, copied from this one.
+			CoffeeMachine* clone() override {
+				RECORD_CREATION("CoffeeMachine::clone", Derived::productName);
+				return new Derived(self());
+			}
+
+			PooledMachine clonePooled() override {
+				RECORD_CREATION("CoffeeMachine::clonePooled", Derived::productName);
+				return makePooled<Derived>(self());
+			}
+
+			MachineBatch cloneBatch(std::size_t count) override {
+				RECORD_CREATIONS("CoffeeMachine::cloneBatch", Derived::productName, count);
+				return MachineBatch::of<Derived>(self(), count);
+			}
+
+			AnyCoffeeMachine cloneAny() override {
+				RECORD_CREATION("CoffeeMachine::cloneAny", Derived::productName);
+				return AnyCoffeeMachine(self());
+			}
+
+			void cloneInto(MachineFleet& fleet) override {
+				RECORD_CREATION("CoffeeMachine::cloneInto", Derived::productName);
+				fleet.add(self());
+			}
+
+		private:
+			const Derived& self() const { return static_cast<const Derived&>(*this); }
+	};
+
+	// Concrete implementations of the prototype - in practice, these would be "complex" objects that cost a lot to instantiate
+	class SimpleCoffeeMachine : public Cloneable<SimpleCoffeeMachine> {
+		public:
+			static constexpr const char *productName = "SimpleCoffeeMachine";
+
+			SimpleCoffeeMachine() = default;
+			explicit SimpleCoffeeMachine(MachineConfig config) : Cloneable(std::move(config)) {}
+
+			void brew() {
+				std::cout << "Brewing simple coffee!\n";
+			}
+	};
+
+	class ComplexCoffeeMachine : public Cloneable<ComplexCoffeeMachine> {
+		public:
+			static constexpr const char *productName = "ComplexCoffeeMachine";
+
+			ComplexCoffeeMachine() = default;
+			explicit ComplexCoffeeMachine(MachineConfig config) : Cloneable(std::move(config)) {}
+
+			void brew() {
+				std::cout << "Brewing complex coffee!\n";
+			}
+	};
+
+	class EspressoMachine : public Cloneable<EspressoMachine> {
+		public:
+			static constexpr const char *productName = "EspressoMachine";
+
+			EspressoMachine() = default;
+			explicit EspressoMachine(MachineConfig config) : Cloneable(std::move(config)) {}
+
+			void brew() {
+				std::cout << "Brewing espresso!\n";
+			}
+	};
+	/** 
+	 * For the above implementations, the clone method - inherited from Cloneable - creates a new machine
+	 * of the concrete type on the heap using the new keyword, copied from the prototype - configuration included.
+	 * This is the function where you can add your own flavour as to how you want objects to be cloned
+	 * according to the pattern.
+	 * For this simple example, we simply use the new keyword to allocate memory for these objects on the heap.
+	 * clonePooled() shows the other option: the copy is placed in a MachinePool (see machine-pool.h),
+	 * so storage freed by one machine is reused by the next clone of the same type.
+	 * cloneBatch() clones many machines at once into one contiguous MachineBatch (see machine-batch.h).
+	 * cloneAny() returns the copy by value, in an AnyCoffeeMachine (see common/any-machine.h).
+	 * cloneInto() adds the copy to a MachineFleet, which keeps each type's machines together (see machine-fleet.h).
+	 */
+
+	// Helper, management class which can abstract the creation of objects via their type.
+
+	/*
+	Further down below, we have our CoffeeMachineManager class. 
+	Although not necessarily required to implement this pattern, it often becomes necessary 
+	in order to successfully create the abstraction around creating objects irrespective of type. 
+	This class provides a static method for creating new coffee machines in a generic way. 
+	This version selects the type either by its integer type ID or by name, and new prototypes
+	can be registered at runtime - by plugins, for example - while other threads keep cloning.
+	*/
+	class CoffeeMachineManager {
+		public:
+			using TypeId = PrototypeRegistry<CoffeeMachine>::TypeId;
+
+			// The built-in prototypes, registered in this order, so their type IDs are 0, 1 and 2.
+			static constexpr TypeId simpleMachine = 0;
+			static constexpr TypeId complexMachine = 1;
+			static constexpr TypeId espressoMachine = 2;
+
+			// Unknown types throw std::out_of_range.
+			static CoffeeMachine* createMachine( TypeId machineType );
+			static CoffeeMachine* createMachine( std::string_view machineName );
+			static PooledMachine createPooledMachine( TypeId machineType );
+			static PooledMachine createPooledMachine( std::string_view machineName );
+
+			// The clone held by value, with no heap allocation for our built-in machines
+			static AnyCoffeeMachine createAnyMachine( TypeId machineType );
+			static AnyCoffeeMachine createAnyMachine( std::string_view machineName );
+
+			// "count" clones of one prototype in a single contiguous block
+			static MachineBatch createMachines( TypeId machineType, std::size_t count );
+			static MachineBatch createMachines( std::string_view machineName, std::size_t count );
+
+			// Clones straight into a fleet of mixed machines
+			static void createMachine( TypeId machineType, MachineFleet& fleet );
+			static void createMachine( std::string_view machineName, MachineFleet& fleet );
+
+			// Adds a new prototype and returns its type ID. Throws std::invalid_argument if the name is taken.
+			static TypeId registerPrototype( std::string name, std::unique_ptr<CoffeeMachine> prototype );
+
+			// Same, but "factory" only builds the prototype when it is first cloned (or warmed up)
+			static TypeId registerPrototype( std::string name, PrototypeRegistry<CoffeeMachine>::Factory factory );
+
+			// Builds every prototype not built yet, in parallel, so that no clone has to wait for one
+			static void warmUp( unsigned threads = std::thread::hardware_concurrency() );
+
+			~CoffeeMachineManager(){}
+
+		private:
+			static PrototypeRegistry<CoffeeMachine>& machines();
+	};
+
+	// The management class contains already instantiated objects so that new objects requested are simply cloned!
+
+	//The magic here is in the machines registry.
+	//The first time it is used, we register one of each of our concrete
+	//prototype classes. Each one is only built when it is first cloned,
+	//so a program never pays for machines it doesn't use.
+	inline PrototypeRegistry<CoffeeMachine>& CoffeeMachineManager::machines()
+	{
+		static PrototypeRegistry<CoffeeMachine> registry;
+		static const bool builtInsRegistered = [] {
+			registry.addLazy("simple", [] { return std::make_unique<SimpleCoffeeMachine>(); });
+			registry.addLazy("complex", [] { return std::make_unique<ComplexCoffeeMachine>(); });
+			registry.addLazy("espresso", [] { return std::make_unique<EspressoMachine>(); });
+			return true;
+		}();
+		(void)builtInsRegistered;
+		return registry;
+	}
+
+	//The createMachine method then becomes our one‑stop‑shop in 
+	//terms of creating objects from our prototype.
+
+	// This helper method will ensure that new machines are not created from scratch but are simply cloned instead
+	inline CoffeeMachine* CoffeeMachineManager::createMachine( TypeId machineType ) 
+	{
+	   RECORD_CREATION("CoffeeMachineManager::createMachine", "by type ID");
+	   return machines().at(machineType).clone();
+	}
+
+	inline CoffeeMachine* CoffeeMachineManager::createMachine( std::string_view machineName )
+	{
+	   RECORD_CREATION("CoffeeMachineManager::createMachine", "by name");
+	   return machines().at(machineName).clone();
+	}
+
+	// Same as createMachine, but the clone lives in a pool and goes back to it when the handle is destroyed
+	inline PooledMachine CoffeeMachineManager::createPooledMachine( TypeId machineType )
+	{
+	   RECORD_CREATION("CoffeeMachineManager::createPooledMachine", "by type ID");
+	   return machines().at(machineType).clonePooled();
+	}
+
+	inline PooledMachine CoffeeMachineManager::createPooledMachine( std::string_view machineName )
+	{
+	   RECORD_CREATION("CoffeeMachineManager::createPooledMachine", "by name");
+	   return machines().at(machineName).clonePooled();
+	}
+
+	// Same as createMachine, but the clone is returned by value
+	inline AnyCoffeeMachine CoffeeMachineManager::createAnyMachine( TypeId machineType )
+	{
+	   RECORD_CREATION("CoffeeMachineManager::createAnyMachine", "by type ID");
+	   return machines().at(machineType).cloneAny();
+	}
+
+	inline AnyCoffeeMachine CoffeeMachineManager::createAnyMachine( std::string_view machineName )
+	{
+	   RECORD_CREATION("CoffeeMachineManager::createAnyMachine", "by name");
+	   return machines().at(machineName).cloneAny();
+	}
+
+	// Bulk version of createMachine, for building whole fleets of identical machines at once
+	inline MachineBatch CoffeeMachineManager::createMachines( TypeId machineType, std::size_t count )
+	{
+	   RECORD_CREATIONS("CoffeeMachineManager::createMachines", "by type ID", count);
+	   return machines().at(machineType).cloneBatch(count);
+	}
+
+	inline MachineBatch CoffeeMachineManager::createMachines( std::string_view machineName, std::size_t count )
+	{
+	   RECORD_CREATIONS("CoffeeMachineManager::createMachines", "by name", count);
+	   return machines().at(machineName).cloneBatch(count);
+	}
+
+	// Same as createMachine, but the clone goes into the fleet, next to the other machines of its type
+	inline void CoffeeMachineManager::createMachine( TypeId machineType, MachineFleet& fleet )
+	{
+	   RECORD_CREATION("CoffeeMachineManager::createMachine", "by type ID, into a fleet");
+	   machines().at(machineType).cloneInto(fleet);
+	}
+
+	inline void CoffeeMachineManager::createMachine( std::string_view machineName, MachineFleet& fleet )
+	{
+	   RECORD_CREATION("CoffeeMachineManager::createMachine", "by name, into a fleet");
+	   machines().at(machineName).cloneInto(fleet);
+	}
+
+	inline CoffeeMachineManager::TypeId CoffeeMachineManager::registerPrototype( std::string name, std::unique_ptr<CoffeeMachine> prototype )
+	{
+	   return machines().add(std::move(name), std::move(prototype));
+	}
+
+	inline CoffeeMachineManager::TypeId CoffeeMachineManager::registerPrototype( std::string name, PrototypeRegistry<CoffeeMachine>::Factory factory )
+	{
+	   return machines().addLazy(std::move(name), std::move(factory));
+	}
+
+	inline void CoffeeMachineManager::warmUp( unsigned threads )
+	{
+	   machines().warmUp(threads);
+	}
+}
@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "../../bench/bench-util.h"
+#include "coffee-recipe.h"
+
+using namespace builderDemo;
+
+/*
+Pouring a cappuccino: written out by hand, from a constexpr preset, through the typestate
+builder, and through the runtime CoffeeBuilder.
+
+Build:
+	g++ -std=c++17 -O2 recipe-benchmark.cpp -o recipe-benchmark
+
+The first three should cost exactly the same. To see that they compile to the same code:
+	g++ -std=c++17 -O2 -c recipe-benchmark.cpp -o recipe-benchmark.o
+	objdump -d --no-show-raw-insn -C recipe-benchmark.o | less    (compare the pour* functions)
+
+The name is short enough for the small-string buffer, so no run allocates and the builders are
+all that is measured.
+*/
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RECIPE_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define RECIPE_NOINLINE __declspec(noinline)
+#else
+#define RECIPE_NOINLINE
+#endif
+
+// The presets are worked out by the compiler; nothing about them is left for run time.
+static_assert(CoffeeRecipes::cappuccino.isHot && CoffeeRecipes::cappuccino.hasMilk && !CoffeeRecipes::cappuccino.hasSugar,
+	"cappuccino is hot with milk");
+static_assert(CoffeeRecipes::cappuccino.cost == 3.50, "cappuccino costs 3.50");
+
+RECIPE_NOINLINE Coffee pourByHand(std::string requestorName) {
+	return Coffee(std::move(requestorName), true, true, false, 3.50);
+}
+
+RECIPE_NOINLINE Coffee pourPreset(std::string requestorName) {
+	return CoffeeRecipes::cappuccino.pour(std::move(requestorName));
+}
+
+RECIPE_NOINLINE Coffee pourTypestate(std::string requestorName) {
+	return CoffeeRecipeBuilder<>().makeHot().addMilk().costs(3.50).build(std::move(requestorName));
+}
+
+RECIPE_NOINLINE Coffee pourCoffeeBuilder(std::string requestorName) {
+	return Coffee::create(std::move(requestorName)).makeHot().addMilk().costs(3.50);
+}
+
+namespace {
+	// Returns false if any coffee came out wrong.
+	template <typename Pour>
+	bool run(const char* name, Pour pour) {
+		const long count = 10000000;
+		double total = 0;
+		bench::Clock::time_point start = bench::Clock::now();
+		for (long i = 0; i < count; i++) {
+			Coffee coffee = pour("Olaf");
+			total += coffee.cost;
+			bench::doNotOptimize(coffee);
+		}
+		bench::report(name, count, bench::secondsSince(start));
+		if (total != 3.50 * count) {
+			std::printf("FAILED: %s poured the wrong coffee\n", name);
+			return false;
+		}
+		return true;
+	}
+}
+
+int main() {
+	bool ok = run("cappuccino, Coffee constructor by hand", pourByHand);
+	ok &= run("cappuccino, constexpr preset", pourPreset);
+	ok &= run("cappuccino, typestate builder", pourTypestate);
+	ok &= run("cappuccino, CoffeeBuilder chain", pourCoffeeBuilder);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
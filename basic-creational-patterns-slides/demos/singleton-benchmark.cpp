@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "singleton.h"
+#include "../../bench/alloc-counter.h"
+#include "../../bench/bench-util.h"
+
+using namespace singletonDemo;
+
+/*
+Multi-threaded read/write benchmark for GlobalCoffeeConfig.
+
+Several reader threads look up a handful of keys in a tight loop, the way request
+handlers do, while one writer thread keeps publishing small batches of changes.
+We compare the published-snapshot store against the original std::map design.
+The original map has no synchronization at all, so to be able to run it next to a
+writer we give it the cheapest correct guard: a std::shared_mutex.
+*/
+class MapCoffeeConfig {
+	std::map<std::string, std::string> coffeeState;
+	std::shared_mutex mutex;
+
+	public:
+		void setState(const std::string &key, const std::string &value) {
+			std::unique_lock<std::shared_mutex> lock(mutex);
+			coffeeState.insert_or_assign(key, value);
+		}
+
+		std::string getState(const std::string &key) {
+			std::shared_lock<std::shared_mutex> lock(mutex);
+			auto iterator = coffeeState.find(key);
+			return iterator == coffeeState.end() ? std::string() : iterator->second;
+		}
+
+		std::size_t lookup(const std::string &key) {
+			std::shared_lock<std::shared_mutex> lock(mutex);
+			auto iterator = coffeeState.find(key);
+			return iterator == coffeeState.end() ? 0 : iterator->second.size();
+		}
+};
+
+static const int keyCount = 1000;
+static const int readsPerThread = 2000000;
+static const int keysPerBatch = 16;
+
+static std::vector<std::string> makeKeys() {
+	std::vector<std::string> keys;
+	for (int i = 0; i < keyCount; i++) {
+		keys.push_back("COFFEE_SETTING_" + std::to_string(i));
+	}
+	return keys;
+}
+
+/*
+Runs "readers" threads calling readOne(key) and one writer calling writeBatch(round)
+until all readers are done, then reports the total read throughput.
+*/
+template <typename ReadOne, typename WriteBatch>
+static void run(const char *name, int readers, ReadOne readOne, WriteBatch writeBatch, const std::vector<std::string> &keys) {
+	std::atomic<bool> done{ false };
+	std::atomic<int> writes{ 0 };
+
+	std::thread writer([&] {
+		for (int round = 0; !done.load(std::memory_order_relaxed); round++) {
+			writeBatch(round);
+			writes.fetch_add(1, std::memory_order_relaxed);
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	});
+
+	auto start = bench::Clock::now();
+	std::vector<std::thread> threads;
+	for (int t = 0; t < readers; t++) {
+		threads.emplace_back([&, t] {
+			std::size_t sum = 0;
+			for (int i = 0; i < readsPerThread; i++) {
+				sum += readOne(keys[(i * 7 + t) % keyCount]);
+			}
+			bench::doNotOptimize(sum);
+		});
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	double seconds = bench::secondsSince(start);
+	done = true;
+	writer.join();
+
+	char label[96];
+	std::snprintf(label, sizeof(label), "%s, %d readers (%d batches)", name, readers, writes.load());
+	bench::report(label, double(readsPerThread) * readers, seconds);
+}
+
+static const int hotReads = 10000000;
+
+/*
+Single-threaded hot reads of one well-known key, the way a request handler checks
+COFFEE_STATUS. Reports the time and the heap allocations per read for each API;
+tests/config-read-test.cpp checks that the allocation-free ones stay that way.
+*/
+template <typename ReadOne>
+static void runHotRead(const char *name, ReadOne readOne) {
+	std::size_t sum = readOne(); // warm-up: the first read on a thread claims a reader slot
+
+	bench::AllocationStats before = bench::AllocationStats::now();
+	auto start = bench::Clock::now();
+	for (int i = 0; i < hotReads; i++) {
+		sum += readOne();
+	}
+	double seconds = bench::secondsSince(start);
+	bench::AllocationStats allocations = bench::AllocationStats::now() - before;
+	bench::doNotOptimize(sum);
+
+	bench::report(name, hotReads, seconds);
+	std::printf("%-48s %12.2f allocations/read\n", "", double(allocations.count) / hotReads);
+}
+
+int main() {
+	std::vector<std::string> keys = makeKeys();
+
+	MapCoffeeConfig mapConfig;
+	GlobalCoffeeConfig &config = GlobalCoffeeConfig::get();
+
+	ConfigBatch initial;
+	for (const std::string &key : keys) {
+		mapConfig.setState(key, "ON");
+		initial.setState(key, "ON");
+	}
+	// Long enough that a copy can't fit in the small-string buffer.
+	initial.setState(std::string(CoffeeKeys::status.name), "ON - brewing at full capacity");
+	config.publish(initial);
+
+	runHotRead("getState(std::string) copy", [&] {
+		return config.getState(std::string("COFFEE_STATUS")).size();
+	});
+	runHotRead("Reader::view(std::string_view)", [&] {
+		GlobalCoffeeConfig::Reader reader(config);
+		return reader.view(std::string_view("COFFEE_STATUS")).size();
+	});
+	runHotRead("Reader::view(ConfigKey)", [&] {
+		GlobalCoffeeConfig::Reader reader(config);
+		return reader.view(CoffeeKeys::status).size();
+	});
+
+	// Noticing changes: polling the values we care about against one load of the version.
+	std::string lastStatus = config.getState(CoffeeKeys::status);
+	std::string lastUrl = config.getState(CoffeeKeys::healthUrl);
+	runHotRead("poll: getState() x2 and compare", [&] {
+		return std::size_t(config.getState(CoffeeKeys::status) != lastStatus ||
+			config.getState(CoffeeKeys::healthUrl) != lastUrl);
+	});
+	std::uint64_t seenVersion = config.version();
+	runHotRead("poll: changedSince(version)", [&] {
+		return std::size_t(config.changedSince(seenVersion));
+	});
+
+	// Subscribers are called off the writer's thread, with changes coalesced per key.
+	std::atomic<int> callbacks{ 0 };
+	auto subscription = config.watch(std::string(CoffeeKeys::status.name), [&](const std::vector<ConfigChange> &) {
+		callbacks.fetch_add(1, std::memory_order_relaxed);
+	});
+	const int statusUpdates = 20000;
+	auto start = bench::Clock::now();
+	for (int i = 0; i < statusUpdates; i++) {
+		config.setState(std::string(CoffeeKeys::status.name), i % 2 ? "ON" : "OFF");
+	}
+	double publishSeconds = bench::secondsSince(start);
+	config.flushNotifications();
+	config.unsubscribe(subscription);
+
+	char label[96];
+	std::snprintf(label, sizeof(label), "setState with a watcher (%d callbacks)", callbacks.load());
+	bench::report(label, statusUpdates, publishSeconds);
+
+	unsigned maxReaders = std::max(4u, std::thread::hardware_concurrency());
+	for (unsigned readers = 1; readers <= maxReaders; readers *= 2) {
+		run("std::map + shared_mutex", readers,
+			[&](const std::string &key) { return mapConfig.lookup(key); },
+			[&](int round) {
+				for (int i = 0; i < keysPerBatch; i++) {
+					mapConfig.setState(keys[(round * keysPerBatch + i) % keyCount], std::to_string(round));
+				}
+			},
+			keys);
+
+		run("published snapshot", readers,
+			[&](const std::string &key) {
+				GlobalCoffeeConfig::Reader reader(config);
+				const std::string *value = reader.find(key);
+				return value ? value->size() : 0;
+			},
+			[&](int round) {
+				ConfigBatch batch;
+				for (int i = 0; i < keysPerBatch; i++) {
+					batch.setState(keys[(round * keysPerBatch + i) % keyCount], std::to_string(round));
+				}
+				config.publish(batch);
+			},
+			keys);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -1,60 +1,13 @@
-#include <map>
+#include <cstdio>
+#include <cstdlib>
 #include <string>
+#include <vector>
+#include "singleton.h"
 
-class GlobalCoffeeConfig {
-    std::map<std::string, std::string>  coffeeState;
+using namespace singletonDemo;
 
-	//Step 1:
-	//The first part in any Singleton in C++ is the private constructor. 	
-	// Private constructor. 
-    GlobalCoffeeConfig() {}
-	// Here we mark a single constructor private as we will not use it
-	// to instantiate new objects.
-	// This is crucial in order to prevent client code from 
-	// creating new objects.
-
-	public:
-		//Step 2:
-		//The next few things we do are to inactivate the copy constructor.
-		//as well as the copy assignment operator.
-		//We need to delete these functions in order to avoid creating
-		//copies of our Singleton.
-
-		// Remove ability to use the copy constructor
-		GlobalCoffeeConfig(GlobalCoffeeConfig const&) = delete;
-
-		// Remove ability top use the copy assignment operator
-		GlobalCoffeeConfig &operator=(GlobalCoffeeConfig const&) = delete;
-
-		//Step 3:
-		//The final portion of any singleton is to provide
-		//a single static method for retrieving the singleton instance.
-
-		// Provide a single, static method for retriving the singleton instance
-		//Here we define a static method, get() that returns a reference to
-		//to our GlobalCoffeeConfig object.
-
-		static GlobalCoffeeConfig &get() {
-			static GlobalCoffeeConfig config;
-			return config;
-		}
-
-		//These are the crucial aspects of the singleton class.
-		//Below them. We implement two simple methods. setState and getState,
-		//that set and retrieve state within the singleton.
-		
-		//In complex example the singleton may contain mutexes in order
-		//to properly log shared resources.
-
-		void setState(const std::string &key, const std::string &value) {
-			coffeeState.insert({ key, value });
-		}
-
-		std::string getState(const std::string &key) {
-			auto iterator = coffeeState.find(key);
-			return iterator->second;
-		}
-};
+// The GlobalCoffeeConfig singleton itself lives in singleton.h so that
+// the benchmarks can share it with this demo.
 
 int main() {
 	// Can't compile this line because the constructor is private
@@ -76,6 +29,28 @@ int main() {
 	printf("COFFEE_STATUS: %s\n", configObj.getState("COFFEE_STATUS").c_str());
 	printf("COFFEE_HEALTH_URL: %s\n", configObj.getState("COFFEE_HEALTH_URL").c_str());
 
+	//On hot paths, read through a Reader with the pre-interned keys instead.
+	//This hands back views into the current snapshot, so nothing is copied or allocated.
+	GlobalCoffeeConfig::Reader reader = configObj.read();
+	std::string_view status = reader.view(CoffeeKeys::status);
+	printf("COFFEE_STATUS (view): %.*s\n", static_cast<int>(status.size()), status.data());
+
+	//Instead of polling getState() for changes, remember the version you last saw,
+	//or let the singleton call you back when a key you care about changes.
+	std::uint64_t seenVersion = configObj.version();
+	auto subscription = configObj.watch("COFFEE_STATUS", [](const std::vector<ConfigChange> &changes) {
+		for (const ConfigChange &change : changes) {
+			printf("%s changed to %s (version %llu)\n", change.key.c_str(), change.value.c_str(),
+				static_cast<unsigned long long>(change.version));
+		}
+	});
+
+	configObj.setState("COFFEE_STATUS", "OFF");
+	configObj.flushNotifications();
+	printf("Changed since version %llu: %s\n", static_cast<unsigned long long>(seenVersion),
+		configObj.changedSince(seenVersion) ? "yes" : "no");
+	configObj.unsubscribe(subscription);
+
     return EXIT_SUCCESS;
 }
 //That's it for the Singleton Pattern.
\ No newline at end of file
@@ -0,0 +1,418 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "config-file.h"
+#include "config-key.h"
+#include "config-watch.h"
+
+namespace singletonDemo {
+
+	/*
+	An immutable, hashed copy of the whole configuration.
+	Once a snapshot is published it is never modified again, so any number of
+	threads can read it at the same time without taking a lock.
+	Writers never touch a published snapshot - they build a new one and swap it in.
+	A snapshot may also sit on top of a mapped config file: keys set in memory win,
+	everything else is looked up in the file.
+	*/
+	class ConfigSnapshot {
+		struct Entry {
+			std::uint64_t hash;
+			std::string key;
+			std::string value;
+		};
+
+		std::vector<Entry> entries;
+		// Open addressing: each slot holds an index into "entries" plus one, 0 means empty.
+		std::vector<std::uint32_t> slots;
+		std::uint64_t snapshotVersion;
+		std::shared_ptr<const MappedConfigFile> file;
+
+		public:
+			ConfigSnapshot(const std::map<std::string, std::string> &state, std::uint64_t version,
+				std::shared_ptr<const MappedConfigFile> file = nullptr)
+				: snapshotVersion(version), file(std::move(file)) {
+				std::size_t capacity = 8;
+				while (capacity < state.size() * 2) {
+					capacity *= 2;
+				}
+				slots.assign(capacity, 0);
+				entries.reserve(state.size());
+
+				for (const auto &keyValue : state) {
+					std::uint64_t hash = hashConfigKey(keyValue.first);
+					entries.push_back({ hash, keyValue.first, keyValue.second });
+
+					std::size_t slot = hash & (capacity - 1);
+					while (slots[slot] != 0) {
+						slot = (slot + 1) & (capacity - 1);
+					}
+					slots[slot] = static_cast<std::uint32_t>(entries.size());
+				}
+			}
+
+			// Looks in memory first, then in the mapped file. Returns false when the key is in neither.
+			bool view(std::string_view key, std::uint64_t hash, std::string_view &value) const {
+				if (const std::string *inMemory = find(key, hash)) {
+					value = *inMemory;
+					return true;
+				}
+				return file && file->find(key, hash, value);
+			}
+
+			// Only sees keys set in memory. Returns nullptr when the key is not present.
+			const std::string *find(std::string_view key) const {
+				return find(key, hashConfigKey(key));
+			}
+
+			const std::string *find(const ConfigKey &key) const {
+				return find(key.name, key.hash);
+			}
+
+			const std::string *find(std::string_view key, std::uint64_t hash) const {
+				std::size_t mask = slots.size() - 1;
+
+				for (std::size_t slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+					const Entry &entry = entries[slots[slot] - 1];
+					if (entry.hash == hash && entry.key == key) {
+						return &entry.value;
+					}
+				}
+				return nullptr;
+			}
+
+			std::size_t size() const { return entries.size(); }
+			std::uint64_t version() const { return snapshotVersion; }
+	};
+
+	/*
+	A group of changes that is published as one new version.
+	Building a snapshot costs O(number of keys), so writers should collect their
+	changes here and publish them together instead of calling setState() per key.
+	*/
+	class ConfigBatch {
+		std::vector<std::pair<std::string, std::string>> changes;
+
+		public:
+			ConfigBatch &setState(std::string key, std::string value) {
+				changes.emplace_back(std::move(key), std::move(value));
+				return *this;
+			}
+
+			bool empty() const { return changes.empty(); }
+
+			friend class GlobalCoffeeConfig;
+	};
+
+	class GlobalCoffeeConfig {
+		/*
+		The writer's private working copy. Only writers touch it, and always while holding
+		"writerMutex". Readers never see this map - they only ever see published snapshots.
+		*/
+	    std::map<std::string, std::string>  coffeeState;
+		std::mutex writerMutex;
+
+		// The config file loaded with loadFile(), if any. Shared by every snapshot built on top of it.
+		std::shared_ptr<const MappedConfigFile> file;
+
+		// The currently published snapshot. Readers load it without locking.
+		std::atomic<const ConfigSnapshot *> current;
+
+		/*
+		The version of "current", kept on its own cache line so that pollers can check
+		for changes with one atomic load and without pinning a snapshot.
+		*/
+		alignas(64) std::atomic<std::uint64_t> publishedVersion{ 0 };
+
+		ConfigWatchers watchers;
+
+		/*
+		Reclaiming old snapshots.
+		A reader announces which snapshot it is using by storing the pointer in its own
+		"hazard" slot. Each slot lives on its own cache line, so readers on different cores
+		never write to the same memory and never bump a shared reference count.
+		A writer that replaces a snapshot parks the old one in "retired" and only deletes it
+		once no hazard slot points at it any more. Writers therefore never wait for readers.
+		*/
+		static constexpr std::size_t maxReaderThreads = 512;
+
+		struct alignas(64) ReaderSlot {
+			std::atomic<const ConfigSnapshot *> hazard{ nullptr };
+			std::atomic<bool> inUse{ false };
+		};
+
+		ReaderSlot readerSlots[maxReaderThreads];
+		std::vector<const ConfigSnapshot *> retired;
+
+		// Per-thread reader bookkeeping: the claimed slot and how deeply reads are nested.
+		struct ThreadReaderState {
+			ReaderSlot *slot = nullptr;
+			const ConfigSnapshot *snapshot = nullptr;
+			int depth = 0;
+
+			~ThreadReaderState() {
+				if (slot) {
+					slot->hazard.store(nullptr, std::memory_order_release);
+					slot->inUse.store(false, std::memory_order_release);
+				}
+			}
+		};
+
+		static ThreadReaderState &threadReaderState() {
+			thread_local ThreadReaderState state;
+			return state;
+		}
+
+		ReaderSlot *claimReaderSlot() {
+			for (ReaderSlot &slot : readerSlots) {
+				bool expected = false;
+				if (!slot.inUse.load(std::memory_order_relaxed) &&
+					slot.inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+					return &slot;
+				}
+			}
+			throw std::runtime_error("GlobalCoffeeConfig: too many concurrent reader threads");
+		}
+
+		//Step 1:
+		//The first part in any Singleton in C++ is the private constructor.
+		// Private constructor.
+	    GlobalCoffeeConfig()
+			: current(new ConfigSnapshot({}, 0)),
+			  watchers([this](const std::string &key) { return getState(key); }) {}
+		// Here we mark a single constructor private as we will not use it
+		// to instantiate new objects.
+		// This is crucial in order to prevent client code from
+		// creating new objects.
+
+		~GlobalCoffeeConfig() {
+			watchers.stop();
+			delete current.load();
+			for (const ConfigSnapshot *snapshot : retired) {
+				delete snapshot;
+			}
+		}
+
+		/*
+		Swaps in a snapshot of the current state and queues "changes" for the watchers.
+		"everything" means a whole config file was swapped in. Called with writerMutex held.
+		*/
+		void publishLocked(std::vector<std::pair<std::string, std::string>> changes, bool everything) {
+			const ConfigSnapshot *previous = current.load(std::memory_order_relaxed);
+			std::uint64_t version = previous->version() + 1;
+			const ConfigSnapshot *next = new ConfigSnapshot(coffeeState, version, file);
+			current.store(next, std::memory_order_seq_cst);
+			publishedVersion.store(version, std::memory_order_release);
+			watchers.enqueue(std::move(changes), version, everything);
+
+			retired.push_back(previous);
+			reclaimRetired();
+		}
+
+		// Deletes every retired snapshot that no reader is looking at any more. Called with writerMutex held.
+		void reclaimRetired() {
+			std::vector<const ConfigSnapshot *> stillInUse;
+			for (const ConfigSnapshot *snapshot : retired) {
+				bool hazardous = false;
+				for (const ReaderSlot &slot : readerSlots) {
+					if (slot.hazard.load(std::memory_order_seq_cst) == snapshot) {
+						hazardous = true;
+						break;
+					}
+				}
+				if (hazardous) {
+					stillInUse.push_back(snapshot);
+				} else {
+					delete snapshot;
+				}
+			}
+			retired.swap(stillInUse);
+		}
+
+		public:
+			//Step 2:
+			//The next few things we do are to inactivate the copy constructor.
+			//as well as the copy assignment operator.
+			//We need to delete these functions in order to avoid creating
+			//copies of our Singleton.
+
+			// Remove ability to use the copy constructor
+			GlobalCoffeeConfig(GlobalCoffeeConfig const&) = delete;
+
+			// Remove ability top use the copy assignment operator
+			GlobalCoffeeConfig &operator=(GlobalCoffeeConfig const&) = delete;
+
+			//Step 3:
+			//The final portion of any singleton is to provide
+			//a single static method for retrieving the singleton instance.
+
+			// Provide a single, static method for retriving the singleton instance
+			//Here we define a static method, get() that returns a reference to
+			//to our GlobalCoffeeConfig object.
+
+			static GlobalCoffeeConfig &get() {
+				static GlobalCoffeeConfig config;
+				return config;
+			}
+
+			/*
+			A Reader pins one snapshot for as long as it lives, so every lookup made through it
+			sees the same consistent version of the configuration, and the pointers it hands out
+			stay valid until the Reader goes out of scope.
+			Readers nest: an inner Reader on the same thread shares the outer one's snapshot.
+			Keep them short-lived - a pinned snapshot can't be reclaimed.
+			*/
+			class Reader {
+				ThreadReaderState &state;
+
+				public:
+					explicit Reader(GlobalCoffeeConfig &config) : state(threadReaderState()) {
+						if (state.depth++ > 0) {
+							return;
+						}
+						if (!state.slot) {
+							state.slot = config.claimReaderSlot();
+						}
+
+						// Publish the hazard, then check the snapshot wasn't swapped out in between.
+						const ConfigSnapshot *snapshot = config.current.load(std::memory_order_seq_cst);
+						for (;;) {
+							state.slot->hazard.store(snapshot, std::memory_order_seq_cst);
+							const ConfigSnapshot *latest = config.current.load(std::memory_order_seq_cst);
+							if (latest == snapshot) {
+								break;
+							}
+							snapshot = latest;
+						}
+						state.snapshot = snapshot;
+					}
+
+					~Reader() {
+						if (--state.depth == 0) {
+							state.slot->hazard.store(nullptr, std::memory_order_release);
+							state.snapshot = nullptr;
+						}
+					}
+
+					Reader(const Reader &) = delete;
+					Reader &operator=(const Reader &) = delete;
+
+					// Only sees keys set in memory, not a loaded config file.
+					// Returns nullptr when the key is not present.
+					const std::string *find(std::string_view key) const { return state.snapshot->find(key); }
+					const std::string *find(const ConfigKey &key) const { return state.snapshot->find(key); }
+
+					// Views into the pinned snapshot or the mapped config file - no copies,
+					// valid until the Reader goes away. Missing keys come back as an empty view.
+					std::string_view view(std::string_view key) const { return view(key, hashConfigKey(key)); }
+					std::string_view view(const ConfigKey &key) const { return view(key.name, key.hash); }
+
+					std::string_view view(std::string_view key, std::uint64_t hash) const {
+						std::string_view value;
+						state.snapshot->view(key, hash, value);
+						return value;
+					}
+
+					std::uint64_t version() const { return state.snapshot->version(); }
+			};
+
+			Reader read() { return Reader(*this); }
+
+			// Publishes every change in the batch as a single new version.
+			void publish(const ConfigBatch &batch) {
+				if (batch.empty()) {
+					return;
+				}
+
+				std::lock_guard<std::mutex> lock(writerMutex);
+				for (const auto &change : batch.changes) {
+					coffeeState.insert_or_assign(change.first, change.second);
+				}
+				publishLocked(batch.changes, false);
+			}
+
+			/*
+			Maps a binary config file (see config-file.h) underneath the in-memory state.
+			Loading is O(1) in the number of keys: nothing is parsed or copied, lookups read
+			straight from the mapping. Keys set with setState()/publish() still take precedence.
+			Throws std::runtime_error if the file can't be opened or isn't a config file.
+			*/
+			void loadFile(const std::string &path) {
+				auto mapped = std::make_shared<const MappedConfigFile>(path);
+
+				std::lock_guard<std::mutex> lock(writerMutex);
+				file = std::move(mapped);
+				publishLocked({}, true);
+			}
+
+			/*
+			Change tracking.
+			version() is bumped by every publish, so "has anything changed since I last looked"
+			is a single atomic load - much cheaper than polling getState() for each key:
+
+				if (config.changedSince(seen)) { seen = config.version(); ...reload... }
+			*/
+			std::uint64_t version() const { return publishedVersion.load(std::memory_order_acquire); }
+			bool changedSince(std::uint64_t seenVersion) const { return version() != seenVersion; }
+
+			/*
+			Calls "callback" on a background thread whenever any of "keys" changes - or any key
+			at all, if "keys" is empty. Changes are batched: each call carries the newest value of
+			every watched key that changed since the previous call, so a busy writer is never slowed
+			down by its subscribers. Callbacks may read the config, and may even publish to it.
+			After loadFile(), watched keys are re-sent with their new values; subscribers to every
+			key get a single change with "reloaded" set instead.
+			*/
+			ConfigWatchers::SubscriptionId subscribe(std::vector<std::string> keys, ConfigWatchers::Callback callback) {
+				return watchers.subscribe(std::move(keys), std::move(callback));
+			}
+
+			ConfigWatchers::SubscriptionId watch(std::string key, ConfigWatchers::Callback callback) {
+				return subscribe({ std::move(key) }, std::move(callback));
+			}
+
+			// No more callbacks for this subscription once this returns.
+			void unsubscribe(ConfigWatchers::SubscriptionId id) { watchers.unsubscribe(id); }
+
+			// Waits until every change published so far has reached the subscribers.
+			void flushNotifications() { watchers.flush(); }
+
+			//These are the crucial aspects of the singleton class.
+			//Below them. We implement two simple methods. setState and getState,
+			//that set and retrieve state within the singleton.
+
+			//In complex example the singleton may contain mutexes in order
+			//to properly log shared resources. Here only writers take a mutex;
+			//readers go through the published snapshot instead.
+
+			//setState publishes a new version for a single key. Prefer publish() with a
+			//ConfigBatch when changing several keys at once.
+			void setState(const std::string &key, const std::string &value) {
+				publish(ConfigBatch().setState(key, value));
+			}
+
+			//getState copies the value out, so it is safe to call from any thread.
+			//Missing keys come back as an empty string.
+			//For allocation-free reads, use a Reader and its view() instead.
+			std::string getState(std::string_view key) {
+				Reader reader(*this);
+				return std::string(reader.view(key));
+			}
+
+			std::string getState(const ConfigKey &key) {
+				Reader reader(*this);
+				return std::string(reader.view(key));
+			}
+	};
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "alloc-stats.h"
+
+/*
+Counts every call to the global operator new.
+This header replaces the global allocation functions, so include it from exactly
+one translation unit per executable - in practice, the benchmark's own .cpp file.
+Other files of the same executable include alloc-stats.h to read the counters.
+*/
+// Kept out of line: if GCC inlines these, it warns that free() is paired with operator new.
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_ALLOCATOR __attribute__((noinline))
+#else
+#define BENCH_ALLOCATOR
+#endif
+
+BENCH_ALLOCATOR void* operator new(std::size_t size) {
+	bench::allocationCount.fetch_add(1, std::memory_order_relaxed);
+	bench::allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	bench::threadAllocatedBytes += size;
+	if (void* memory = std::malloc(size ? size : 1)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+BENCH_ALLOCATOR void* operator new[](std::size_t size) {
+	return ::operator new(size);
+}
+
+BENCH_ALLOCATOR void* operator new(std::size_t size, std::align_val_t alignment) {
+	bench::allocationCount.fetch_add(1, std::memory_order_relaxed);
+	bench::allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	bench::threadAllocatedBytes += size;
+	std::size_t align = static_cast<std::size_t>(alignment);
+	if (void* memory = std::aligned_alloc(align, (size + align - 1) / align * align + (size ? 0 : align))) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+BENCH_ALLOCATOR void* operator new[](std::size_t size, std::align_val_t alignment) {
+	return ::operator new(size, alignment);
+}
+
+BENCH_ALLOCATOR void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
+
+BENCH_ALLOCATOR void operator delete[](void* memory) noexcept {
+	std::free(memory);
+}
+
+BENCH_ALLOCATOR void operator delete(void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+BENCH_ALLOCATOR void operator delete[](void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+BENCH_ALLOCATOR void operator delete(void* memory, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+BENCH_ALLOCATOR void operator delete[](void* memory, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+BENCH_ALLOCATOR void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+BENCH_ALLOCATOR void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+	std::free(memory);
+}
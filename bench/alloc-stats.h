@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// The counters behind alloc-counter.h, for files that only read them.
+namespace bench {
+
+	inline std::atomic<std::size_t> allocationCount{ 0 };
+	inline std::atomic<std::size_t> allocatedBytes{ 0 };
+
+	// The same bytes, counted for the allocating thread only - what creationStats::setAllocatedBytesSource() wants.
+	inline thread_local std::size_t threadAllocatedBytes = 0;
+
+	// Snapshot of the counters, so a benchmark can report the difference around a block of work.
+	struct AllocationStats {
+		std::size_t count;
+		std::size_t bytes;
+
+		static AllocationStats now() {
+			return { allocationCount.load(std::memory_order_relaxed), allocatedBytes.load(std::memory_order_relaxed) };
+		}
+
+		AllocationStats operator-(const AllocationStats& earlier) const {
+			return { count - earlier.count, bytes - earlier.bytes };
+		}
+	};
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <streambuf>
+
+/*
+Small helpers shared by the demo benchmarks.
+Every benchmark in this repo is a plain executable with its own main(),
+so all we need here is a clock, a way to stop the optimizer from deleting
+the work we are trying to measure, and a consistent way of printing results.
+*/
+namespace bench {
+
+	using Clock = std::chrono::steady_clock;
+
+	inline double secondsSince(Clock::time_point start) {
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	// Tells the compiler that "value" is used, so the computation producing it can't be removed.
+	template <typename T>
+	inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+	/*
+	The demo classes print from brew(), stir() and friends. While one of these is alive,
+	std::cout swallows everything, so we measure the calls rather than the terminal.
+	The formatting work inside operator<< still happens and is still timed.
+	*/
+	class SilenceStdout {
+		struct NullBuffer : std::streambuf {
+			int overflow(int c) override { return traits_type::not_eof(c); }
+			std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+		};
+
+		NullBuffer nullBuffer;
+		std::streambuf* previous;
+
+		public:
+			SilenceStdout() : previous(std::cout.rdbuf(&nullBuffer)) {}
+			~SilenceStdout() { std::cout.rdbuf(previous); }
+
+			SilenceStdout(const SilenceStdout&) = delete;
+			SilenceStdout& operator=(const SilenceStdout&) = delete;
+	};
+
+	// One line per measurement: name, total operations and the derived rates.
+	inline void report(const char* name, double operations, double seconds) {
+		std::printf("%-48s %12.0f ops %10.3f ms %10.2f ns/op %14.0f ops/s\n",
+			name, operations, seconds * 1e3, seconds * 1e9 / operations, operations / seconds);
+	}
+}
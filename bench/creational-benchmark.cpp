@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../instrumentation/creation-stats.h"
+#include "alloc-counter.h"
+#include "harness.h"
+
+/*
+Creation latency, allocations per object and throughput for every creational pattern in the
+repo, all under the same workload (see harness.h), written out as JSON for tracking regressions.
+
+	creational-benchmark [--json FILE] [--stats FILE] [--prometheus FILE] [PATTERN...]
+
+Progress goes to stderr. The JSON goes to FILE, or to stdout without --json.
+PATTERN limits the run to some of: builder prototype singleton factory-method abstract-factory
+dependency-injection.
+
+creational-benchmark-instrumented is the same program built with CREATIONAL_INSTRUMENTATION
+(see instrumentation/creation-stats.h): comparing the two shows what the instrumentation costs.
+--stats and --prometheus write what it recorded, as JSON or in the Prometheus text format.
+*/
+
+namespace {
+	struct Pattern {
+		const char* name;
+		void (*run)();
+	};
+
+	const Pattern patterns[] = {
+		{ "builder", bench::workloads::builder },
+		{ "prototype", bench::workloads::prototype },
+		{ "singleton", bench::workloads::singleton },
+		{ "factory-method", bench::workloads::factoryMethod },
+		{ "abstract-factory", bench::workloads::abstractFactory },
+		{ "dependency-injection", bench::workloads::dependencyInjection },
+	};
+
+	std::string quoted(const std::string& text) {
+		std::string json = "\"";
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				json += '\\';
+			}
+			json += c;
+		}
+		return json + "\"";
+	}
+
+	void writeJson(std::ostream& out, double clockOverheadNs) {
+		out << "{\n"
+			<< "  \"creationCount\": " << bench::creationCount << ",\n"
+			<< "  \"latencySamples\": " << bench::latencySamples << ",\n"
+			<< "  \"clockOverheadNs\": " << clockOverheadNs << ",\n"
+			<< "  \"results\": [";
+		const char* separator = "\n";
+		for (const bench::CreationResult& result : bench::creationResults()) {
+			out << separator
+				<< "    {\"pattern\": " << quoted(result.pattern)
+				<< ", \"variant\": " << quoted(result.variant)
+				<< ", \"nsPerObject\": " << result.seconds * 1e9 / bench::creationCount
+				<< ", \"objectsPerSecond\": " << bench::creationCount / result.seconds
+				<< ", \"allocationsPerObject\": " << result.allocationsPerObject
+				<< ", \"bytesPerObject\": " << result.bytesPerObject
+				<< ", \"latencyNs\": {\"p50\": " << result.p50Ns << ", \"p90\": " << result.p90Ns
+				<< ", \"p99\": " << result.p99Ns << ", \"max\": " << result.maxNs << "}}";
+			separator = ",\n";
+		}
+		out << "\n  ]\n}\n";
+	}
+
+	bool writeFile(const char* path, const std::string& text) {
+		std::ofstream file(path);
+		file << text;
+		if (!file) {
+			std::fprintf(stderr, "creational-benchmark: cannot write \"%s\"\n", path);
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	const char* jsonPath = nullptr;
+	const char* statsPath = nullptr;
+	const char* prometheusPath = nullptr;
+	std::vector<std::string> selected;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+			jsonPath = argv[++i];
+		} else if (std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+			statsPath = argv[++i];
+		} else if (std::strcmp(argv[i], "--prometheus") == 0 && i + 1 < argc) {
+			prometheusPath = argv[++i];
+		} else {
+			selected.push_back(argv[i]);
+		}
+	}
+
+	for (const std::string& name : selected) {
+		bool known = false;
+		for (const Pattern& pattern : patterns) {
+			known |= name == pattern.name;
+		}
+		if (!known) {
+			std::fprintf(stderr, "creational-benchmark: unknown pattern \"%s\"\n", name.c_str());
+			return 2;
+		}
+	}
+
+	creationStats::setAllocatedBytesSource([] { return bench::threadAllocatedBytes; });
+
+	double clockOverheadNs = bench::clockOverheadNs();
+	std::fprintf(stderr, "clock overhead per latency sample: %.0f ns\n", clockOverheadNs);
+
+	for (const Pattern& pattern : patterns) {
+		if (selected.empty() || std::find(selected.begin(), selected.end(), pattern.name) != selected.end()) {
+			pattern.run();
+		}
+	}
+
+	// Every creation path a workload reached was measured at least creationCount times.
+	for (const creationStats::CreationSummary& summary : creationStats::collect()) {
+		if (summary.count < std::uint64_t(bench::creationCount)) {
+			std::fprintf(stderr, "FAILED: %s (%s) recorded only %llu creations\n", summary.factory.c_str(),
+				summary.product.c_str(), static_cast<unsigned long long>(summary.count));
+			return 1;
+		}
+	}
+	if ((statsPath && !writeFile(statsPath, creationStats::toJson())) ||
+		(prometheusPath && !writeFile(prometheusPath, creationStats::toPrometheus()))) {
+		return 1;
+	}
+
+	if (jsonPath) {
+		std::ofstream file(jsonPath);
+		writeJson(file, clockOverheadNs);
+		if (!file) {
+			std::fprintf(stderr, "creational-benchmark: cannot write \"%s\"\n", jsonPath);
+			return 1;
+		}
+	} else {
+		writeJson(std::cout, clockOverheadNs);
+	}
+	return 0;
+}
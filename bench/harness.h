@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "alloc-stats.h"
+#include "bench-util.h"
+
+/*
+The shared harness behind creational-benchmark.
+
+Every pattern runs the same workload: create one product the pattern's way, hand it to
+doNotOptimize, and destroy it again. measureCreation() does that "creationCount" times
+for throughput and allocations per object, then times "latencySamples" single creations
+one by one for the latency percentiles. Results are collected here and written out as
+JSON by creational-benchmark.cpp.
+*/
+namespace bench {
+
+	constexpr long creationCount = 1000000;
+	constexpr long latencySamples = 100000;
+
+	struct CreationResult {
+		std::string pattern;
+		std::string variant;
+		double seconds;
+		double allocationsPerObject;
+		double bytesPerObject;
+		double p50Ns;
+		double p90Ns;
+		double p99Ns;
+		double maxNs;
+	};
+
+	// What timing one empty iteration costs; it is included in every latency sample.
+	inline double clockOverheadNs() {
+		std::vector<double> samples(10000);
+		for (double& sample : samples) {
+			Clock::time_point one = Clock::now();
+			sample = std::chrono::duration<double, std::nano>(Clock::now() - one).count();
+		}
+		std::sort(samples.begin(), samples.end());
+		return samples[samples.size() / 2];
+	}
+
+	inline std::vector<CreationResult>& creationResults() {
+		static std::vector<CreationResult> results;
+		return results;
+	}
+
+	// "create" returns the product; it is destroyed at the end of each iteration.
+	template <typename Create>
+	void measureCreation(const char* pattern, const char* variant, Create create) {
+		for (int i = 0; i < 1000; i++) {
+			doNotOptimize(create());
+		}
+
+		AllocationStats before = AllocationStats::now();
+		Clock::time_point start = Clock::now();
+		for (long i = 0; i < creationCount; i++) {
+			doNotOptimize(create());
+		}
+		double seconds = secondsSince(start);
+		AllocationStats used = AllocationStats::now() - before;
+
+		std::vector<double> latencies(latencySamples);
+		for (double& latency : latencies) {
+			Clock::time_point one = Clock::now();
+			doNotOptimize(create());
+			latency = std::chrono::duration<double, std::nano>(Clock::now() - one).count();
+		}
+		std::sort(latencies.begin(), latencies.end());
+		auto percentile = [&latencies](double p) { return latencies[std::size_t(p * (latencies.size() - 1))]; };
+
+		creationResults().push_back({ pattern, variant, seconds,
+			double(used.count) / creationCount, double(used.bytes) / creationCount,
+			percentile(0.50), percentile(0.90), percentile(0.99), latencies.back() });
+
+		std::string name = std::string(pattern) + ": " + variant;
+		std::fprintf(stderr, "%-52s %8.2f ns/op %12.0f ops/s %6.2f allocs/op  p50 %6.0f ns  p99 %6.0f ns\n",
+			name.c_str(), seconds * 1e9 / creationCount, creationCount / seconds,
+			double(used.count) / creationCount, percentile(0.50), percentile(0.99));
+	}
+
+	// One function per pattern, each in its own file under bench/workloads.
+	namespace workloads {
+		void builder();
+		void prototype();
+		void singleton();
+		void factoryMethod();
+		void abstractFactory();
+		void dependencyInjection();
+	}
+}
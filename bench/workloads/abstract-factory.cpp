@@ -0,0 +1,31 @@
+#include <memory>
+#include <utility>
+
+#include "../../advanced-creational-patterns-slides/demos/abstract-factory.h"
+#include "../harness.h"
+
+// One product here is a whole family: a machine and a matching coffee.
+void bench::workloads::abstractFactory() {
+	using namespace abstractFactoryDemo;
+
+	static RobustCoffeeFactory robust;
+	static CoffeeFactory& factory = robust;
+
+	measureCreation("abstract-factory", "CoffeeFactory& family (heap)", [] {
+		return std::make_pair(factory.createMachine(), factory.createCoffee());
+	});
+
+	static OrderArena arena;
+	measureCreation("abstract-factory", "CoffeeFactory& family (OrderArena)", [] {
+		{
+			CoffeeFactory::Family family = factory.createFamily(arena);
+			doNotOptimize(family);
+		}
+		arena.release();
+		return 0;
+	});
+
+	measureCreation("abstract-factory", "StaticCoffeeFactory family (by value)", [] {
+		return std::make_pair(StaticCoffeeFactory<RobustFamily>::createMachine(), StaticCoffeeFactory<RobustFamily>::createCoffee());
+	});
+}
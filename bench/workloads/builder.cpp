@@ -0,0 +1,20 @@
+#include "../../basic-creational-patterns-slides/demos/builder.h"
+#include "../../basic-creational-patterns-slides/demos/coffee-recipe.h"
+#include "../harness.h"
+
+void bench::workloads::builder() {
+	using namespace builderDemo;
+
+	measureCreation("builder", "CoffeeBuilder chain", [] {
+		Coffee coffee = Coffee::create("Olaf").makeHot().addMilk().costs(3.50);
+		return coffee;
+	});
+
+	measureCreation("builder", "CoffeeOrder build()", [] {
+		return CoffeeOrder("Olaf").makeHot().addMilk().costs(3.50).build();
+	});
+
+	measureCreation("builder", "constexpr recipe pour()", [] {
+		return CoffeeRecipes::cappuccino.pour("Olaf");
+	});
+}
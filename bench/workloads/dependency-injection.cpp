@@ -0,0 +1,39 @@
+#include <memory>
+
+#include "../../advanced-creational-patterns-slides/demos/dep-injection/coffee-machine.h"
+#include "../../advanced-creational-patterns-slides/demos/dep-injection/injector.h"
+#include "../harness.h"
+
+namespace dependencyInjectionDemo {
+
+	struct NullCoffeeService : ICoffeeService {
+		void sendMetrics() override {}
+	};
+}
+
+// A CoffeeMachine with its metrics service, wired up four ways.
+void bench::workloads::dependencyInjection() {
+	using namespace dependencyInjectionDemo;
+
+	measureCreation("dependency-injection", "owned service (make_unique)", [] {
+		return CoffeeMachine(std::make_unique<NullCoffeeService>());
+	});
+
+	static std::shared_ptr<ICoffeeService> shared = std::make_shared<NullCoffeeService>();
+	measureCreation("dependency-injection", "shared service", [] {
+		return CoffeeMachine(shared);
+	});
+
+	static NullCoffeeService borrowed;
+	measureCreation("dependency-injection", "borrowed service", [] {
+		return CoffeeMachine(borrowed);
+	});
+
+	static Injector injector = InjectorBuilder()
+		.add<ICoffeeService, NullCoffeeService>(ServiceLifetime::singleton)
+		.add<CoffeeMachine, CoffeeMachine, ICoffeeService>(ServiceLifetime::transient)
+		.build();
+	measureCreation("dependency-injection", "Injector::resolve (transient)", [] {
+		return injector.resolve<CoffeeMachine>();
+	});
+}
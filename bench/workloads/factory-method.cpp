@@ -0,0 +1,30 @@
+#include <memory>
+
+#include "../../advanced-creational-patterns-slides/demos/factory-method.h"
+#include "../harness.h"
+
+void bench::workloads::factoryMethod() {
+	using namespace factoryMethodDemo;
+
+	static CoffeeMachineFactory factory;
+
+	measureCreation("factory-method", "createMachine(int) (heap)", [] {
+		return factory.createMachine(2);
+	});
+
+	measureCreation("factory-method", "createMachine(name) (heap)", [] {
+		return factory.createMachine(std::string_view("robust"));
+	});
+
+	measureCreation("factory-method", "createMachineValue(int) (variant)", [] {
+		return CoffeeMachineFactory::createMachineValue(2);
+	});
+
+	measureCreation("factory-method", "createAnyMachine(int) (AnyCoffeeMachine)", [] {
+		return CoffeeMachineFactory::createAnyMachine(2);
+	});
+
+	measureCreation("factory-method", "createMachine<2>() (by value)", [] {
+		return CoffeeMachineFactory::createMachine<2>();
+	});
+}
@@ -0,0 +1,24 @@
+#include <memory>
+
+#include "../../basic-creational-patterns-slides/demos/prototype.h"
+#include "../harness.h"
+
+void bench::workloads::prototype() {
+	using namespace prototypeDemo;
+
+	measureCreation("prototype", "clone by type ID (heap)", [] {
+		return std::unique_ptr<CoffeeMachine>(CoffeeMachineManager::createMachine(CoffeeMachineManager::simpleMachine));
+	});
+
+	measureCreation("prototype", "clone by name (heap)", [] {
+		return std::unique_ptr<CoffeeMachine>(CoffeeMachineManager::createMachine("simple"));
+	});
+
+	measureCreation("prototype", "clone by type ID (pooled)", [] {
+		return CoffeeMachineManager::createPooledMachine(CoffeeMachineManager::simpleMachine);
+	});
+
+	measureCreation("prototype", "clone by type ID (AnyCoffeeMachine)", [] {
+		return CoffeeMachineManager::createAnyMachine(CoffeeMachineManager::simpleMachine);
+	});
+}
@@ -0,0 +1,20 @@
+#include <string>
+
+#include "../../basic-creational-patterns-slides/demos/singleton.h"
+#include "../harness.h"
+
+// A singleton is created once; what every caller pays for is getting hold of it and reading from it.
+void bench::workloads::singleton() {
+	using namespace singletonDemo;
+
+	GlobalCoffeeConfig::get().setState(std::string(CoffeeKeys::status.name), "Brewing");
+
+	measureCreation("singleton", "get() + Reader lookup", [] {
+		GlobalCoffeeConfig::Reader reader = GlobalCoffeeConfig::get().read();
+		return reader.find(CoffeeKeys::status);
+	});
+
+	measureCreation("singleton", "get() + getState() copy", [] {
+		return GlobalCoffeeConfig::get().getState(CoffeeKeys::status);
+	});
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+A coffee machine held by value: any class derived from "Machine", behind one handle type.
+
+Small machines - up to InlineCapacity bytes, which covers every machine in these demos - are
+stored inside the handle itself, so creating one needs no heap allocation and using one no
+pointer chase: a std::vector of handles keeps its machines back to back. Bigger machines, and
+ones whose move could throw, go on the heap as a unique_ptr would put them.
+
+Copying a handle copies the machine it holds, the way clone() does; moving one moves it.
+That relies on the machine having real move operations: a base class with a virtual
+destructor has to default them explicitly, or every "move" quietly copies instead.
+
+	AnyCoffeeMachine machine = CoffeeMachineManager::createAnyMachine(CoffeeMachineManager::espressoMachine);
+	machine->brew();
+
+Each hierarchy names its own handle: using AnyCoffeeMachine = BasicAnyCoffeeMachine<CoffeeMachine>;
+*/
+template <typename Machine, std::size_t InlineCapacity = 32>
+class BasicAnyCoffeeMachine {
+	// What the handle needs to know about the concrete type it holds.
+	struct Operations {
+		Machine *(*copy)(const Machine &from, void *buffer);
+		Machine *(*move)(Machine &from, void *buffer); // inline machines only
+		void (*destroy)(Machine *machine);
+		bool isInline;
+	};
+
+	template <typename T>
+	static constexpr bool fitsInline = sizeof(T) <= InlineCapacity &&
+		alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>;
+
+	template <typename T>
+	struct Model {
+		static Machine *copy(const Machine &from, void *buffer) {
+			const T &concrete = static_cast<const T &>(from);
+			if constexpr (fitsInline<T>) {
+				return new (buffer) T(concrete);
+			} else {
+				return new T(concrete);
+			}
+		}
+
+		static Machine *move(Machine &from, void *buffer) {
+			if constexpr (fitsInline<T>) {
+				T &concrete = static_cast<T &>(from);
+				T *moved = new (buffer) T(std::move(concrete));
+				concrete.~T();
+				return moved;
+			} else {
+				return nullptr;
+			}
+		}
+
+		static void destroy(Machine *machine) {
+			if constexpr (fitsInline<T>) {
+				static_cast<T *>(machine)->~T();
+			} else {
+				delete static_cast<T *>(machine);
+			}
+		}
+
+		static constexpr Operations operations{ &copy, &move, &destroy, fitsInline<T> };
+	};
+
+	alignas(std::max_align_t) unsigned char buffer[InlineCapacity];
+	Machine *machine = nullptr;
+	const Operations *operations = nullptr;
+
+	template <typename T, typename... Args>
+	void construct(Args &&...args) {
+		static_assert(std::is_base_of_v<Machine, T>, "an AnyCoffeeMachine can only hold a machine");
+		static_assert(std::is_copy_constructible_v<T>, "an AnyCoffeeMachine is copied by copying its machine");
+		if constexpr (fitsInline<T>) {
+			machine = new (buffer) T(std::forward<Args>(args)...);
+		} else {
+			machine = new T(std::forward<Args>(args)...);
+		}
+		operations = &Model<T>::operations;
+	}
+
+	void takeFrom(BasicAnyCoffeeMachine &other) noexcept {
+		if (!other.machine) {
+			return;
+		}
+		machine = other.operations->isInline ? other.operations->move(*other.machine, buffer) : other.machine;
+		operations = other.operations;
+		other.machine = nullptr;
+		other.operations = nullptr;
+	}
+
+	public:
+		static constexpr std::size_t inlineCapacity = InlineCapacity;
+
+		// An empty handle, holding no machine.
+		BasicAnyCoffeeMachine() noexcept {}
+
+		// Copies or moves a concrete machine into the handle.
+		template <typename T, typename = std::enable_if_t<std::is_base_of_v<Machine, std::decay_t<T>>>>
+		BasicAnyCoffeeMachine(T &&concrete) {
+			construct<std::decay_t<T>>(std::forward<T>(concrete));
+		}
+
+		// Builds a T straight inside the handle: BasicAnyCoffeeMachine::make<EspressoMachine>(config).
+		template <typename T, typename... Args>
+		static BasicAnyCoffeeMachine make(Args &&...args) {
+			BasicAnyCoffeeMachine handle;
+			handle.template construct<T>(std::forward<Args>(args)...);
+			return handle;
+		}
+
+		BasicAnyCoffeeMachine(const BasicAnyCoffeeMachine &other) {
+			if (other.machine) {
+				machine = other.operations->copy(*other.machine, buffer);
+				operations = other.operations;
+			}
+		}
+
+		BasicAnyCoffeeMachine(BasicAnyCoffeeMachine &&other) noexcept { takeFrom(other); }
+
+		BasicAnyCoffeeMachine &operator=(const BasicAnyCoffeeMachine &other) {
+			if (this != &other) {
+				BasicAnyCoffeeMachine copy(other);
+				reset();
+				takeFrom(copy);
+			}
+			return *this;
+		}
+
+		BasicAnyCoffeeMachine &operator=(BasicAnyCoffeeMachine &&other) noexcept {
+			if (this != &other) {
+				reset();
+				takeFrom(other);
+			}
+			return *this;
+		}
+
+		~BasicAnyCoffeeMachine() { reset(); }
+
+		void reset() noexcept {
+			if (machine) {
+				operations->destroy(machine);
+				machine = nullptr;
+				operations = nullptr;
+			}
+		}
+
+		Machine *get() const { return machine; }
+		Machine *operator->() const { return machine; }
+		Machine &operator*() const { return *machine; }
+		explicit operator bool() const { return machine != nullptr; }
+
+		// True if the machine lives inside the handle rather than on the heap.
+		bool isInline() const { return operations && operations->isInline; }
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+A group of threads that is joined, at the latest, when it goes out of scope.
+
+A joinable std::thread that is destroyed calls std::terminate. So a plain
+std::vector<std::thread> filled in a loop is a trap: if starting the third thread throws,
+unwinding destroys the first two while they still run. Started through a JoiningThreads,
+they are joined instead, and the exception carries on from there.
+
+Declare the group after everything its threads use, so that it is destroyed - and its
+threads joined - first.
+
+	JoiningThreads workers;
+	for (unsigned t = 1; t < threads; t++) {
+		workers.start(work, t);
+	}
+	work(0);
+	workers.join();
+*/
+class JoiningThreads {
+	std::vector<std::thread> threads;
+
+	public:
+		JoiningThreads() = default;
+
+		JoiningThreads(const JoiningThreads &) = delete;
+		JoiningThreads &operator=(const JoiningThreads &) = delete;
+
+		~JoiningThreads() { join(); }
+
+		// Starts std::thread(args...). Throws whatever starting it throws; the threads already started keep running.
+		template <typename... Args>
+		void start(Args &&...args) {
+			threads.emplace_back(std::forward<Args>(args)...);
+		}
+
+		void reserve(std::size_t count) { threads.reserve(count); }
+		std::size_t size() const { return threads.size(); }
+
+		// Waits for every thread started so far.
+		void join() {
+			for (std::thread &thread : threads) {
+				if (thread.joinable()) {
+					thread.join();
+				}
+			}
+			threads.clear();
+		}
+};
@@ -0,0 +1,433 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+Counts, bytes and latency of every creation path, for finding out which one dominates.
+
+Each factory marks what it creates with RECORD_CREATION, at the top of the function:
+
+	std::unique_ptr<CoffeeMachine> createMachine() {
+		RECORD_CREATION("CoffeeFactory::createMachine", "SimpleCoffeeMachine");
+		return std::make_unique<SimpleCoffeeMachine>();
+	}
+
+Every factory and creation function in the demos is marked, by-value ones included. What user code
+constructs directly - with a plain constructor, or through a factory it registered with the
+dependency injection Injector - is only counted where the constructor itself is marked, as the
+dependency injection CoffeeMachine's are.
+
+A function that creates many objects at once records them with RECORD_CREATIONS(factory,
+product, objects): they add "objects" to the count, and the latency recorded is the whole batch's.
+
+Unless the program is compiled with CREATIONAL_INSTRUMENTATION defined, RECORD_CREATION
+expands to nothing and the factories compile exactly as if it weren't there; toJson() and
+toPrometheus() still exist, so code that serves them builds either way, but report nothing.
+
+When enabled, a creation costs a few writes to memory only the creating thread touches: every
+thread records into its own shard, and shards are only added up when the stats are read.
+Reading the clock costs more than many creations do, so only one creation in
+latencySampleEvery is timed. The sampled latencies go into a log-linear histogram in the style
+of HdrHistogram: 8 buckets per power of two, so any value is within 12.5% of the bucket it is
+reported as.
+
+Bytes are only known if the program tells us how much its thread has allocated so far -
+from its allocator (jemalloc's "thread.allocatedp", say) or its own operator new - with
+setAllocatedBytesSource(). Without one, bytes are reported as 0.
+*/
+namespace creationStats {
+
+#ifdef CREATIONAL_INSTRUMENTATION
+	constexpr bool enabled = true;
+#else
+	constexpr bool enabled = false;
+#endif
+
+	using Clock = std::chrono::steady_clock;
+
+	// Distinct RECORD_CREATION sites a program may have.
+	constexpr std::size_t maxSites = 64;
+
+	// Each thread times the first creation at a site, and every 16th after that.
+	constexpr std::uint64_t latencySampleEvery = 16;
+
+	// Values below 8 ns get a bucket each; above that, 8 buckets per power of two, up to 2^40 ns (about 18 minutes).
+	constexpr std::size_t subBuckets = 8;
+	constexpr unsigned maxExponent = 39;
+	constexpr std::size_t bucketCount = (maxExponent - 2) * subBuckets + subBuckets;
+
+	inline std::size_t bucketFor(std::uint64_t nanoseconds) {
+		nanoseconds = std::min<std::uint64_t>(nanoseconds, (std::uint64_t(1) << (maxExponent + 1)) - 1);
+		if (nanoseconds < subBuckets) {
+			return static_cast<std::size_t>(nanoseconds);
+		}
+#if defined(__GNUC__) || defined(__clang__)
+		unsigned exponent = 63 - __builtin_clzll(nanoseconds);
+#else
+		unsigned exponent = maxExponent;
+		while (!(nanoseconds >> exponent)) {
+			exponent--;
+		}
+#endif
+		return (exponent - 2) * subBuckets + ((nanoseconds >> (exponent - 3)) & (subBuckets - 1));
+	}
+
+	// The smallest value that no longer falls into "bucket".
+	inline std::uint64_t bucketUpperNs(std::size_t bucket) {
+		bucket++;
+		if (bucket < subBuckets) {
+			return bucket;
+		}
+		unsigned exponent = static_cast<unsigned>(bucket / subBuckets) + 2;
+		return (subBuckets + bucket % subBuckets) << (exponent - 3);
+	}
+
+	// Everything recorded for one factory and product, added up over all threads.
+	struct CreationSummary {
+		std::string factory;
+		std::string product;
+		std::uint64_t count = 0;
+		std::uint64_t bytes = 0;
+		// The timed creations only: how many, their total time, and their histogram.
+		std::uint64_t samples = 0;
+		std::uint64_t totalNs = 0;
+		std::vector<std::uint64_t> buckets = std::vector<std::uint64_t>(bucketCount);
+
+		// Upper bound of the bucket holding the p-th fraction of the samples; 0 when there are none.
+		std::uint64_t percentileNs(double p) const {
+			std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(p * samples + 0.5));
+			std::uint64_t seen = 0;
+			for (std::size_t bucket = 0; bucket < bucketCount; bucket++) {
+				seen += buckets[bucket];
+				if (seen >= rank) {
+					return bucketUpperNs(bucket);
+				}
+			}
+			return 0;
+		}
+
+		std::uint64_t maxNs() const { return percentileNs(1.0); }
+	};
+
+	inline std::atomic<std::size_t (*)()> allocatedBytesSource{ nullptr };
+
+	// "source" returns how many bytes the calling thread has allocated in total so far.
+	inline void setAllocatedBytesSource(std::size_t (*source)()) {
+		allocatedBytesSource.store(source, std::memory_order_release);
+	}
+
+#ifdef CREATIONAL_INSTRUMENTATION
+	class Site;
+
+	// One thread's counters for one site. Only the owning thread writes them.
+	struct SiteCounters {
+		std::atomic<std::uint64_t> count{ 0 };
+		std::atomic<std::uint64_t> bytes{ 0 };
+		std::atomic<std::uint64_t> totalNs{ 0 };
+		std::atomic<std::uint64_t> buckets[bucketCount] = {};
+
+		// A plain load and store, not a read-modify-write: nobody else writes this counter.
+		static void add(std::atomic<std::uint64_t> &counter, std::uint64_t amount) {
+			counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+		}
+	};
+
+	// Every site's counters for one thread, on cache lines of their own. Reused once the thread exits.
+	struct alignas(64) Shard {
+		std::atomic<SiteCounters *> sites[maxSites] = {};
+		std::atomic<bool> inUse{ false };
+
+		~Shard() {
+			for (std::atomic<SiteCounters *> &site : sites) {
+				delete site.load();
+			}
+		}
+
+		SiteCounters &counters(std::size_t site) {
+			SiteCounters *counters = sites[site].load(std::memory_order_relaxed);
+			if (!counters) {
+				counters = new SiteCounters();
+				sites[site].store(counters, std::memory_order_release);
+			}
+			return *counters;
+		}
+	};
+
+	class Registry {
+		std::atomic<const Site *> sites[maxSites] = {};
+		std::atomic<std::size_t> siteCount{ 0 };
+
+		std::mutex shardMutex;
+		std::vector<std::unique_ptr<Shard>> shards;
+
+		public:
+			static Registry &get() {
+				static Registry registry;
+				return registry;
+			}
+
+			// Throws std::length_error once there are more than maxSites sites.
+			std::size_t addSite(const Site *site) {
+				std::size_t index = siteCount.fetch_add(1, std::memory_order_relaxed);
+				if (index >= maxSites) {
+					throw std::length_error("creationStats: more than " + std::to_string(maxSites) + " creation sites");
+				}
+				sites[index].store(site, std::memory_order_release);
+				return index;
+			}
+
+			Shard *claimShard() {
+				std::lock_guard<std::mutex> lock(shardMutex);
+				for (const std::unique_ptr<Shard> &shard : shards) {
+					bool expected = false;
+					if (shard->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+						return shard.get();
+					}
+				}
+				shards.push_back(std::make_unique<Shard>());
+				shards.back()->inUse.store(true, std::memory_order_relaxed);
+				return shards.back().get();
+			}
+
+			std::vector<CreationSummary> collect();
+	};
+
+	// One RECORD_CREATION: which factory made which product.
+	class Site {
+		public:
+			const char *const factory;
+			const char *const product;
+			const std::size_t index;
+
+			Site(const char *factory, const char *product)
+				: factory(factory), product(product), index(Registry::get().addSite(this)) {}
+
+			Site(const Site &) = delete;
+			Site &operator=(const Site &) = delete;
+	};
+
+	// Sites with the same factory and product are reported together.
+	inline std::vector<CreationSummary> Registry::collect() {
+		std::vector<CreationSummary> summaries;
+		std::size_t summaryOf[maxSites];
+		std::size_t count = std::min(siteCount.load(std::memory_order_acquire), maxSites);
+		for (std::size_t index = 0; index < count; index++) {
+			summaryOf[index] = maxSites;
+			const Site *site = sites[index].load(std::memory_order_acquire);
+			if (!site) {
+				continue; // still being registered
+			}
+			auto same = std::find_if(summaries.begin(), summaries.end(), [site](const CreationSummary &summary) {
+				return summary.factory == site->factory && summary.product == site->product;
+			});
+			if (same == summaries.end()) {
+				summaries.emplace_back();
+				summaries.back().factory = site->factory;
+				summaries.back().product = site->product;
+				same = summaries.end() - 1;
+			}
+			summaryOf[index] = static_cast<std::size_t>(same - summaries.begin());
+		}
+
+		std::lock_guard<std::mutex> lock(shardMutex);
+		for (const std::unique_ptr<Shard> &shard : shards) {
+			for (std::size_t index = 0; index < count; index++) {
+				const SiteCounters *counters = shard->sites[index].load(std::memory_order_acquire);
+				if (!counters || summaryOf[index] == maxSites) {
+					continue;
+				}
+				CreationSummary &summary = summaries[summaryOf[index]];
+				summary.count += counters->count.load(std::memory_order_relaxed);
+				summary.bytes += counters->bytes.load(std::memory_order_relaxed);
+				summary.totalNs += counters->totalNs.load(std::memory_order_relaxed);
+				for (std::size_t bucket = 0; bucket < bucketCount; bucket++) {
+					std::uint64_t inBucket = counters->buckets[bucket].load(std::memory_order_relaxed);
+					summary.buckets[bucket] += inBucket;
+					summary.samples += inBucket;
+				}
+			}
+		}
+		return summaries;
+	}
+
+	// The calling thread's shard, claimed on its first creation and handed back when it exits.
+	inline Shard &threadShard() {
+		struct ShardHandle {
+			Shard *shard = Registry::get().claimShard();
+			~ShardHandle() { shard->inUse.store(false, std::memory_order_release); }
+		};
+		thread_local ShardHandle handle;
+		return *handle.shard;
+	}
+
+	inline std::size_t threadAllocatedBytes() {
+		std::size_t (*source)() = allocatedBytesSource.load(std::memory_order_acquire);
+		return source ? source() : 0;
+	}
+
+	// Records whatever runs until the end of the enclosing scope as "objects" creations. A creation that throws isn't recorded.
+	class Scope {
+		SiteCounters &counters;
+		std::uint64_t objects;
+		bool timed;
+		int uncaught = std::uncaught_exceptions();
+		std::size_t bytesBefore = threadAllocatedBytes();
+		Clock::time_point start;
+
+		// Timed if the creations numbered [first, first + objects) include a multiple of latencySampleEvery.
+		static bool sampled(std::uint64_t first, std::uint64_t objects) {
+			return (first + latencySampleEvery - 1) / latencySampleEvery * latencySampleEvery < first + objects;
+		}
+
+		public:
+			explicit Scope(const Site &site, std::uint64_t objects = 1)
+				: counters(threadShard().counters(site.index)), objects(objects),
+				  timed(sampled(counters.count.load(std::memory_order_relaxed), objects)) {
+				if (timed) {
+					start = Clock::now();
+				}
+			}
+
+			~Scope() {
+				Clock::time_point end = timed ? Clock::now() : start;
+				if (std::uncaught_exceptions() != uncaught) {
+					return;
+				}
+				SiteCounters::add(counters.count, objects);
+				SiteCounters::add(counters.bytes, threadAllocatedBytes() - bytesBefore);
+				if (timed) {
+					std::uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+					SiteCounters::add(counters.totalNs, nanoseconds);
+					SiteCounters::add(counters.buckets[bucketFor(nanoseconds)], 1);
+				}
+			}
+
+			Scope(const Scope &) = delete;
+			Scope &operator=(const Scope &) = delete;
+	};
+
+	// Every site reached so far, in the order they were first reached. Safe to call while other threads create.
+	inline std::vector<CreationSummary> collect() { return Registry::get().collect(); }
+#else
+	inline std::vector<CreationSummary> collect() { return {}; }
+#endif
+
+	inline std::string quoted(const std::string &text) {
+		std::string escaped = "\"";
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				escaped += '\\';
+			}
+			escaped += c;
+		}
+		return escaped + "\"";
+	}
+
+	inline std::string number(double value) {
+		char text[32];
+		std::snprintf(text, sizeof(text), "%.9g", value);
+		return text;
+	}
+
+	/*
+	{"enabled": true, "creations": [{"factory": ..., "product": ..., "count": ..., "bytes": ...,
+	"latencySamples": ..., "meanNs": ..., "p50Ns": ..., "p90Ns": ..., "p99Ns": ..., "maxNs": ...,
+	"histogram": [[upperNs, samples], ...]}, ...]} - the latencies are over the timed creations only,
+	and the histogram lists non-empty buckets only.
+	*/
+	inline std::string toJson() {
+		std::string json = std::string("{\"enabled\": ") + (enabled ? "true" : "false") + ", \"creations\": [";
+		const char *separator = "\n";
+		for (const CreationSummary &summary : collect()) {
+			json += separator;
+			json += "  {\"factory\": " + quoted(summary.factory) + ", \"product\": " + quoted(summary.product)
+				+ ", \"count\": " + std::to_string(summary.count) + ", \"bytes\": " + std::to_string(summary.bytes)
+				+ ", \"latencySamples\": " + std::to_string(summary.samples)
+				+ ", \"meanNs\": " + number(summary.samples ? double(summary.totalNs) / summary.samples : 0)
+				+ ", \"p50Ns\": " + std::to_string(summary.percentileNs(0.50))
+				+ ", \"p90Ns\": " + std::to_string(summary.percentileNs(0.90))
+				+ ", \"p99Ns\": " + std::to_string(summary.percentileNs(0.99))
+				+ ", \"maxNs\": " + std::to_string(summary.maxNs()) + ", \"histogram\": [";
+			const char *bucketSeparator = "";
+			for (std::size_t bucket = 0; bucket < bucketCount; bucket++) {
+				if (summary.buckets[bucket] != 0) {
+					json += bucketSeparator;
+					json += "[" + std::to_string(bucketUpperNs(bucket)) + ", " + std::to_string(summary.buckets[bucket]) + "]";
+					bucketSeparator = ", ";
+				}
+			}
+			json += "]}";
+			separator = ",\n";
+		}
+		return json + "\n]}\n";
+	}
+
+	/*
+	Prometheus text format: a counter of creations and one of bytes, and the sampled latencies
+	as a histogram with a bucket for every power of two from 16 ns to about 17 s.
+	*/
+	inline std::string toPrometheus() {
+		std::vector<CreationSummary> summaries = collect();
+		auto labels = [](const CreationSummary &summary) {
+			return "factory=" + quoted(summary.factory) + ",product=" + quoted(summary.product);
+		};
+
+		std::string text =
+			"# HELP coffee_creations_total Objects created, by factory and product.\n"
+			"# TYPE coffee_creations_total counter\n";
+		for (const CreationSummary &summary : summaries) {
+			text += "coffee_creations_total{" + labels(summary) + "} " + std::to_string(summary.count) + "\n";
+		}
+
+		text +=
+			"# HELP coffee_creation_allocated_bytes_total Bytes allocated while creating, by factory and product.\n"
+			"# TYPE coffee_creation_allocated_bytes_total counter\n";
+		for (const CreationSummary &summary : summaries) {
+			text += "coffee_creation_allocated_bytes_total{" + labels(summary) + "} " + std::to_string(summary.bytes) + "\n";
+		}
+
+		text +=
+			"# HELP coffee_creation_duration_seconds Time taken by the timed creations, by factory and product.\n"
+			"# TYPE coffee_creation_duration_seconds histogram\n";
+		for (const CreationSummary &summary : summaries) {
+			std::uint64_t cumulative = 0;
+			std::size_t bucket = 0;
+			for (unsigned exponent = 4; exponent <= 34; exponent++) {
+				std::uint64_t bound = std::uint64_t(1) << exponent;
+				for (; bucket < bucketCount && bucketUpperNs(bucket) <= bound; bucket++) {
+					cumulative += summary.buckets[bucket];
+				}
+				text += "coffee_creation_duration_seconds_bucket{" + labels(summary) + ",le=\"" + number(bound * 1e-9) + "\"} "
+					+ std::to_string(cumulative) + "\n";
+			}
+			text += "coffee_creation_duration_seconds_bucket{" + labels(summary) + ",le=\"+Inf\"} " + std::to_string(summary.samples) + "\n";
+			text += "coffee_creation_duration_seconds_sum{" + labels(summary) + "} " + number(summary.totalNs * 1e-9) + "\n";
+			text += "coffee_creation_duration_seconds_count{" + labels(summary) + "} " + std::to_string(summary.samples) + "\n";
+		}
+		return text;
+	}
+}
+
+#ifdef CREATIONAL_INSTRUMENTATION
+#define CREATION_STATS_CONCAT_(a, b) a##b
+#define CREATION_STATS_CONCAT(a, b) CREATION_STATS_CONCAT_(a, b)
+#define RECORD_CREATION(factory, product) \
+	static const ::creationStats::Site CREATION_STATS_CONCAT(creationSite, __LINE__)(factory, product); \
+	::creationStats::Scope CREATION_STATS_CONCAT(creationScope, __LINE__)(CREATION_STATS_CONCAT(creationSite, __LINE__))
+#define RECORD_CREATIONS(factory, product, objects) \
+	static const ::creationStats::Site CREATION_STATS_CONCAT(creationSite, __LINE__)(factory, product); \
+	::creationStats::Scope CREATION_STATS_CONCAT(creationScope, __LINE__)(CREATION_STATS_CONCAT(creationSite, __LINE__), objects)
+#else
+#define RECORD_CREATION(factory, product) ((void)0)
+#define RECORD_CREATIONS(factory, product, objects) ((void)0)
+#endif
@@ -0,0 +1,75 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "../basic-creational-patterns-slides/demos/singleton.h"
+#include "../bench/alloc-counter.h"
+
+using namespace singletonDemo;
+
+/*
+Reads from GlobalCoffeeConfig that are meant not to touch the heap: views through a Reader,
+by name or by ConfigKey, polling the version, and getState(ConfigKey) of a value short
+enough for the small-string buffer.
+*/
+
+namespace {
+	bool check(bool ok, const char *what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+		}
+		return ok;
+	}
+
+	// Runs "read" a few times and returns how often the heap was used meanwhile.
+	template <typename Read>
+	std::size_t allocationsOf(Read read) {
+		read(); // the first read on a thread claims a reader slot
+		bench::AllocationStats before = bench::AllocationStats::now();
+		for (int i = 0; i < 1000; i++) {
+			read();
+		}
+		return (bench::AllocationStats::now() - before).count;
+	}
+}
+
+int main() {
+	GlobalCoffeeConfig &config = GlobalCoffeeConfig::get();
+	ConfigBatch batch;
+	// Long enough that a copy can't fit in the small-string buffer.
+	batch.setState(std::string(CoffeeKeys::status.name), "ON - brewing at full capacity");
+	batch.setState(std::string(CoffeeKeys::healthUrl.name), "OK");
+	config.publish(batch);
+
+	bool ok = true;
+	{
+		GlobalCoffeeConfig::Reader reader(config);
+		ok &= check(reader.view(std::string_view("COFFEE_STATUS")) == "ON - brewing at full capacity" &&
+			reader.view(CoffeeKeys::status) == "ON - brewing at full capacity" && reader.view(CoffeeKeys::healthUrl) == "OK",
+			"views should see the published values");
+		ok &= check(config.getState(CoffeeKeys::healthUrl) == "OK", "getState() should copy the published value");
+	}
+
+	std::size_t length = 0;
+	ok &= check(allocationsOf([&] {
+		GlobalCoffeeConfig::Reader reader(config);
+		length += reader.view(std::string_view("COFFEE_STATUS")).size();
+	}) == 0, "Reader::view(std::string_view) should not allocate");
+	ok &= check(allocationsOf([&] {
+		GlobalCoffeeConfig::Reader reader(config);
+		length += reader.view(CoffeeKeys::status).size();
+	}) == 0, "Reader::view(ConfigKey) should not allocate");
+	ok &= check(allocationsOf([&] {
+		length += config.getState(CoffeeKeys::healthUrl).size();
+	}) == 0, "getState(ConfigKey) of a short value should not allocate");
+
+	std::uint64_t seen = config.version();
+	bool changed = false;
+	ok &= check(allocationsOf([&] { changed |= config.changedSince(seen); }) == 0 && !changed,
+		"changedSince() should not allocate");
+	ok &= check(length > 0, "the reads should have found the values");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
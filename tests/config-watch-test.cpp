@@ -0,0 +1,117 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../basic-creational-patterns-slides/demos/singleton.h"
+
+using namespace singletonDemo;
+
+/*
+Change subscriptions on GlobalCoffeeConfig: what a keyed subscriber and a subscriber to every
+key are told about setState(), loadFile() and a batch that mixes the two.
+*/
+
+namespace {
+	// Everything one subscriber was called with, one entry per call.
+	class Recorder {
+		std::mutex mutex;
+		std::vector<std::vector<ConfigChange>> calls;
+
+		public:
+			ConfigWatchers::Callback callback() {
+				return [this](const std::vector<ConfigChange> &changes) {
+					std::lock_guard<std::mutex> lock(mutex);
+					calls.push_back(changes);
+				};
+			}
+
+			std::vector<std::vector<ConfigChange>> take() {
+				std::lock_guard<std::mutex> lock(mutex);
+				std::vector<std::vector<ConfigChange>> taken;
+				taken.swap(calls);
+				return taken;
+			}
+	};
+
+	bool check(bool ok, const char *what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+		}
+		return ok;
+	}
+
+	bool isChange(const ConfigChange &change, const char *key, const char *value) {
+		return !change.reloaded && change.key == key && change.value == value;
+	}
+}
+
+int main() {
+	std::string path = (std::filesystem::temp_directory_path() / "config-watch-test.ccfg").string();
+	writeConfigFile({ { "COFFEE_STATUS", "FROM_FILE" }, { "COFFEE_HEALTH_URL", "https://coffee.local/health" } }, path);
+
+	GlobalCoffeeConfig &config = GlobalCoffeeConfig::get();
+	Recorder keyed;
+	Recorder everyKey;
+	ConfigWatchers::SubscriptionId keyedId = config.watch("COFFEE_STATUS", keyed.callback());
+	ConfigWatchers::SubscriptionId everyKeyId = config.subscribe({}, everyKey.callback());
+	bool ok = true;
+
+	config.setState("COFFEE_STATUS", "ON");
+	config.flushNotifications();
+	std::vector<std::vector<ConfigChange>> keyedCalls = keyed.take();
+	std::vector<std::vector<ConfigChange>> everyKeyCalls = everyKey.take();
+	ok &= check(keyedCalls.size() == 1 && keyedCalls[0].size() == 1 && isChange(keyedCalls[0][0], "COFFEE_STATUS", "ON"),
+		"a keyed subscriber should get the new value of its key");
+	ok &= check(everyKeyCalls.size() == 1 && everyKeyCalls[0].size() == 1 && isChange(everyKeyCalls[0][0], "COFFEE_STATUS", "ON"),
+		"a subscriber to every key should get the new value of any key");
+
+	config.setState("COFFEE_GRIND", "FINE");
+	config.flushNotifications();
+	ok &= check(keyed.take().empty(), "a keyed subscriber should not hear about other keys");
+	ok &= check(everyKey.take().size() == 1, "a subscriber to every key should hear about every key");
+
+	// Memory wins over the file, so the keyed subscriber still sees "ON"; it is re-sent all the same.
+	config.loadFile(path);
+	std::uint64_t loadVersion = config.version();
+	config.flushNotifications();
+	keyedCalls = keyed.take();
+	everyKeyCalls = everyKey.take();
+	ok &= check(keyedCalls.size() == 1 && keyedCalls[0].size() == 1 && isChange(keyedCalls[0][0], "COFFEE_STATUS", "ON") &&
+		keyedCalls[0][0].version == loadVersion, "after loadFile() a keyed subscriber should get its key again");
+	ok &= check(everyKeyCalls.size() == 1 && !everyKeyCalls[0].empty() && everyKeyCalls[0][0].reloaded &&
+		everyKeyCalls[0][0].key.empty() && everyKeyCalls[0][0].version == loadVersion,
+		"after loadFile() a subscriber to every key should get a reloaded marker first");
+	ok &= check(config.getState("COFFEE_HEALTH_URL") == "https://coffee.local/health", "keys only in the file should be readable");
+
+	// A change and a reload queued together may arrive in one call or two; a marker always leads its call.
+	config.unsubscribe(keyedId);
+	config.setState("COFFEE_GRIND", "COARSE");
+	config.loadFile(path);
+	config.flushNotifications();
+	everyKeyCalls = everyKey.take();
+	bool mixed = !everyKeyCalls.empty();
+	bool sawMarker = false;
+	bool sawGrind = false;
+	for (const std::vector<ConfigChange> &call : everyKeyCalls) {
+		for (std::size_t i = 0; i < call.size(); i++) {
+			if (call[i].reloaded) {
+				sawMarker = true;
+				mixed &= i == 0;
+			} else {
+				sawGrind |= isChange(call[i], "COFFEE_GRIND", "COARSE");
+			}
+		}
+	}
+	ok &= check(mixed && sawMarker && sawGrind, "a change and a reload together should bring both, marker first");
+	ok &= check(keyed.take().empty(), "an unsubscribed callback should not be called again");
+
+	config.unsubscribe(everyKeyId);
+	std::filesystem::remove(path);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
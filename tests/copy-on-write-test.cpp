@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+
+#include "../basic-creational-patterns-slides/demos/prototype.h"
+
+using namespace prototypeDemo;
+
+/*
+CopyOnWrite sharing, and what is left of a CopyOnWrite - or a machine holding one - after a move.
+*/
+
+namespace {
+	bool check(bool ok, const char *what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+		}
+		return ok;
+	}
+
+	MachineConfig calibrated() {
+		MachineConfig config;
+		config.calibration = { 1.0f, 2.0f, 3.0f };
+		return config;
+	}
+}
+
+int main() {
+	CopyOnWrite<MachineConfig> original(calibrated());
+	CopyOnWrite<MachineConfig> copy = original;
+	bool ok = check(copy.shared() && &copy.read() == &original.read(), "a copy should share the value");
+	copy.write().calibration.push_back(4.0f);
+	ok &= check(!copy.shared() && original.read().calibration.size() == 3 && copy.read().calibration.size() == 4,
+		"writing should give the writer its own value");
+
+	CopyOnWrite<MachineConfig> moved(std::move(original));
+	ok &= check(moved.read().calibration.size() == 3, "a move should take the value along");
+	ok &= check(original.read().calibration.empty() && &original.read() == &CopyOnWrite<MachineConfig>().read(),
+		"a moved-from value should be empty, like a default-constructed one");
+	original.write().calibration.push_back(5.0f);
+	ok &= check(original.read().calibration.size() == 1 && moved.read().calibration.size() == 3 &&
+		CopyOnWrite<MachineConfig>().read().calibration.empty(), "writing to a moved-from value should not touch anything else");
+
+	SimpleCoffeeMachine machine(calibrated());
+	SimpleCoffeeMachine taken(std::move(machine));
+	std::unique_ptr<CoffeeMachine> clone(machine.clone());
+	ok &= check(machine.configuration().calibration.empty() && clone->configuration().calibration.empty() &&
+		taken.configuration().calibration.size() == 3, "a moved-from machine should still clone, with an empty configuration");
+	ok &= check(clone->sharesConfiguration() && machine.sharesConfiguration(), "a moved-from machine shares the empty configuration");
+	machine.reconfigure().calibration.push_back(1.0f);
+	ok &= check(machine.configuration().calibration.size() == 1 && !machine.sharesConfiguration() &&
+		clone->configuration().calibration.empty(), "a moved-from machine can be reconfigured on its own");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,189 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "../bench/bench-util.h"
+#include "../advanced-creational-patterns-slides/demos/dep-injection/coffee-machine.h"
+#include "../advanced-creational-patterns-slides/demos/dep-injection/injector.h"
+
+using namespace dependencyInjectionDemo;
+
+/*
+The injector's lifetimes, and the graphs build() must reject.
+*/
+
+namespace {
+	int failures = 0;
+
+	void check(bool condition, const char *what) {
+		if (!condition) {
+			std::printf("FAILED: %s\n", what);
+			failures++;
+		}
+	}
+
+	template <typename Exception, typename Action>
+	void checkThrows(Action action, const char *what) {
+		try {
+			action();
+		} catch (const Exception &) {
+			return;
+		}
+		check(false, what);
+	}
+
+	struct CountingCoffeeService : ICoffeeService {
+		int sent = 0;
+		void sendMetrics() override { sent++; }
+	};
+
+	// A chain of layers, each holding the one below it: every fourth is scoped, the rest transient.
+	template <int Depth>
+	struct Layer {
+		std::shared_ptr<Layer<Depth - 1>> inner;
+		std::shared_ptr<ICoffeeService> metrics;
+
+		Layer(std::shared_ptr<Layer<Depth - 1>> inner, std::shared_ptr<ICoffeeService> metrics)
+			: inner(std::move(inner)), metrics(std::move(metrics)) {}
+	};
+
+	template <>
+	struct Layer<0> {
+		std::shared_ptr<ICoffeeService> metrics;
+
+		explicit Layer(std::shared_ptr<ICoffeeService> metrics) : metrics(std::move(metrics)) {}
+	};
+
+	constexpr ServiceLifetime layerLifetime(int depth) {
+		return depth % 4 == 0 ? ServiceLifetime::scoped : ServiceLifetime::transient;
+	}
+
+	template <std::size_t... Depth>
+	void addLayers(InjectorBuilder &builder, std::index_sequence<Depth...>) {
+		(builder.add<Layer<Depth + 1>, Layer<Depth + 1>, Layer<Depth>, ICoffeeService>(layerLifetime(Depth + 1)), ...);
+	}
+
+	struct Shared {
+		static inline int built = 0;
+		Shared() { built++; }
+	};
+	struct Left {
+		std::shared_ptr<Shared> shared;
+		explicit Left(std::shared_ptr<Shared> shared) : shared(std::move(shared)) {}
+	};
+	struct Right {
+		std::shared_ptr<Shared> shared;
+		explicit Right(std::shared_ptr<Shared> shared) : shared(std::move(shared)) {}
+	};
+	struct Diamond {
+		std::shared_ptr<Left> left;
+		std::shared_ptr<Right> right;
+		Diamond(std::shared_ptr<Left> left, std::shared_ptr<Right> right) : left(std::move(left)), right(std::move(right)) {}
+	};
+	struct Cyclic {
+		explicit Cyclic(std::shared_ptr<Cyclic>) {}
+	};
+
+	void checkLifetimes() {
+		InjectorBuilder builder;
+		builder.add<ICoffeeService, CountingCoffeeService>(ServiceLifetime::singleton);
+		builder.add<Layer<0>, Layer<0>, ICoffeeService>(layerLifetime(0));
+		addLayers(builder, std::make_index_sequence<9>{});
+		Injector injector = builder.build();
+
+		Injector::Scope first(injector);
+		Injector::Scope second(injector);
+		check(first.resolve<ICoffeeService>() == second.resolve<ICoffeeService>(), "a singleton is shared by every scope");
+		check(first.resolve<Layer<8>>() == first.resolve<Layer<8>>(), "a scoped service is shared within its scope");
+		check(first.resolve<Layer<8>>() != second.resolve<Layer<8>>(), "each scope gets its own scoped service");
+		check(first.resolve<Layer<9>>() != first.resolve<Layer<9>>(), "a transient service is new every time");
+		check(first.resolve<Layer<9>>()->inner == first.resolve<Layer<8>>(), "a transient gets the scope's instance of a scoped dependency");
+		check(first.resolve<Layer<7>>()->inner != first.resolve<Layer<7>>()->inner, "a transient dependency is new for every service that needs it");
+		check(first.resolve<Layer<7>>()->metrics == injector.resolve<ICoffeeService>(), "every layer reports to the singleton");
+	}
+
+	void checkDiamonds() {
+		// Right is already in the scope when Diamond is resolved, so it isn't built again; Shared must still be one object.
+		InjectorBuilder scopedShared;
+		scopedShared.add<Shared>(ServiceLifetime::scoped);
+		scopedShared.add<Left, Left, Shared>(ServiceLifetime::transient);
+		scopedShared.add<Right, Right, Shared>(ServiceLifetime::scoped);
+		scopedShared.add<Diamond, Diamond, Left, Right>(ServiceLifetime::transient);
+		Injector diamonds = scopedShared.build();
+		Injector::Scope scope(diamonds);
+		std::shared_ptr<Right> right = scope.resolve<Right>();
+		std::shared_ptr<Diamond> diamond = scope.resolve<Diamond>();
+		check(diamond->right == right && diamond->left->shared == right->shared, "a diamond shares one scoped service");
+
+		// A transient reached along two paths is built once per path, and only then.
+		InjectorBuilder transientShared;
+		transientShared.add<Shared>(ServiceLifetime::transient);
+		transientShared.add<Left, Left, Shared>(ServiceLifetime::transient);
+		transientShared.add<Right, Right, Shared>(ServiceLifetime::transient);
+		transientShared.add<Diamond, Diamond, Left, Right>(ServiceLifetime::transient);
+		Injector transients = transientShared.build();
+		Shared::built = 0;
+		diamond = transients.resolve<Diamond>();
+		check(Shared::built == 2 && diamond->left->shared != diamond->right->shared, "a transient diamond builds its shared dependency once per path");
+	}
+
+	void checkFactories() {
+		InjectorBuilder machines;
+		machines.add<ICoffeeService, CountingCoffeeService>(ServiceLifetime::singleton);
+		machines.addFactory<CoffeeMachine, ICoffeeService>(ServiceLifetime::transient, [](std::shared_ptr<ICoffeeService> service) {
+			return std::make_shared<CoffeeMachine>(std::move(service));
+		});
+		Injector machineInjector = machines.build();
+		{
+			bench::SilenceStdout silence;
+			machineInjector.resolve<CoffeeMachine>()->brew();
+			machineInjector.resolve<CoffeeMachine>()->brew();
+		}
+		auto counter = std::static_pointer_cast<CountingCoffeeService>(machineInjector.resolve<ICoffeeService>());
+		check(counter->sent == 2, "machines built by a factory share the singleton metrics service");
+	}
+
+	void checkRejectedGraphs() {
+		InjectorBuilder empty;
+		Injector injector = empty.build();
+		checkThrows<std::out_of_range>([&] { injector.resolve<Cyclic>(); }, "resolving an unregistered service throws");
+		checkThrows<std::invalid_argument>([] {
+			InjectorBuilder duplicate;
+			duplicate.add<Shared>(ServiceLifetime::scoped);
+			duplicate.add<Shared>(ServiceLifetime::transient);
+		}, "registering a service twice throws");
+		checkThrows<std::logic_error>([] {
+			InjectorBuilder missing;
+			missing.add<Left, Left, Shared>(ServiceLifetime::transient);
+			missing.build();
+		}, "a missing dependency is rejected by build()");
+		checkThrows<std::logic_error>([] {
+			InjectorBuilder cycle;
+			cycle.add<Cyclic, Cyclic, Cyclic>(ServiceLifetime::transient);
+			cycle.build();
+		}, "a dependency cycle is rejected by build()");
+		checkThrows<std::logic_error>([] {
+			InjectorBuilder captive;
+			captive.add<Shared>(ServiceLifetime::scoped);
+			captive.add<Left, Left, Shared>(ServiceLifetime::transient);
+			captive.add<Diamond, Diamond, Left, Right>(ServiceLifetime::singleton);
+			captive.add<Right, Right, Shared>(ServiceLifetime::transient);
+			captive.build();
+		}, "a singleton capturing a scoped service is rejected by build()");
+	}
+}
+
+int main() {
+	checkLifetimes();
+	checkDiamonds();
+	checkFactories();
+	checkRejectedGraphs();
+
+	if (failures != 0) {
+		std::printf("%d check(s) failed\n", failures);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#include "../basic-creational-patterns-slides/demos/order-store.h"
+
+using namespace builderDemo;
+
+/*
+Copies of a CoffeeOrderStore: a copy must keep answering by requestor name after the store
+it was copied from is gone, since its name index can't point into the original's names.
+*/
+
+namespace {
+	bool check(bool ok, const char *what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+		}
+		return ok;
+	}
+
+	std::unique_ptr<CoffeeOrderStore> makeStore() {
+		auto store = std::make_unique<CoffeeOrderStore>();
+		store->order("alice").makeHot().addMilk().costs(3.50);
+		store->order("bob").addSugar().costs(2.00);
+		store->order("alice").costs(1.50);
+		return store;
+	}
+
+	bool checkAnswers(const CoffeeOrderStore &store, const char *what) {
+		std::uint32_t id;
+		return check(store.size() == 3 && store.countFor("alice") == 2 && store.totalCostFor("alice") == 5.00 &&
+			store.countFor("bob") == 1 && store.names().find("bob", id) && store.names().name(id) == "bob" &&
+			store.at(2).requestor() == "alice", what);
+	}
+}
+
+int main() {
+	std::unique_ptr<CoffeeOrderStore> original = makeStore();
+	CoffeeOrderStore copied(*original);
+	CoffeeOrderStore assigned;
+	assigned.order("carol").costs(9.00);
+	assigned = *original;
+	original.reset();
+
+	bool ok = checkAnswers(copied, "a copied store should outlive the original");
+	ok &= checkAnswers(assigned, "a store assigned from another should outlive it");
+
+	// New names go into the copy's own table.
+	copied.order("dave").costs(4.00);
+	ok &= check(copied.countFor("dave") == 1 && assigned.countFor("dave") == 0, "a copy should intern names on its own");
+
+	CoffeeOrderStore moved(std::move(copied));
+	ok &= check(moved.countFor("alice") == 2 && moved.countFor("dave") == 1, "a moved store should keep its names");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}